@@ -3,15 +3,43 @@
 #include "FormulaBaseListener.h"
 #include "FormulaLexer.h"
 #include "FormulaParser.h"
+#include "memory_usage.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdio>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <sstream>
 
 namespace ASTImpl {
 
+    //      FormulaAST::GetCells():  
+    //       ,   
+    class FormulaCells {
+    public:
+        explicit FormulaCells(const std::vector<const CellInterface*>& cells)
+            : bound_(cells.data()) {
+        }
+
+        FormulaCells(const SheetInterface& sheet, const std::vector<Position>& positions)
+            : sheet_(&sheet)
+            , positions_(positions.data()) {
+        }
+
+        //    index  nullptr,   
+        const CellInterface* operator[](std::size_t index) const {
+            return bound_ ? bound_[index] : sheet_->GetCell(positions_[index]);
+        }
+
+    private:
+        const CellInterface* const* bound_ = nullptr;
+        const SheetInterface* sheet_ = nullptr;
+        const Position* positions_ = nullptr;
+    };
+
     enum ExprPrecedence {
         EP_ADD,
         EP_SUB,
@@ -71,30 +99,52 @@ namespace ASTImpl {
     public:
         virtual ~Expr() = default;
         virtual void Print(std::ostream& out) const = 0;
-        virtual void DoPrintFormula(std::ostream& out, ExprPrecedence precedence) const = 0;
-        virtual double Evaluate(std::function<CellInterface::Value(Position)> cell_func) const = 0;
+        //         
+        virtual void DoPrintFormula(std::string& out, ExprPrecedence precedence) const = 0;
+        // cells -     FormulaAST::GetCells(), nullptr  
+        virtual double Evaluate(const FormulaCells& cells) const = 0;
+        //           
+        virtual void IndexCells(const std::vector<Position>& cells) = 0;
+        //        
+        virtual void Compile(FormulaProgram& program) const = 0;
+        //     
+        virtual std::size_t GetMemoryUsage() const = 0;
+        //           
+        // nullptr,   .     changed
+        virtual std::unique_ptr<Expr> Simplify(bool& changed) = 0;
+        //  ,      
+        virtual std::optional<double> GetConstant() const {
+            return std::nullopt;
+        }
 
         // higher is tighter
         virtual ExprPrecedence GetPrecedence() const = 0;
 
-        void PrintFormula(std::ostream& out, ExprPrecedence parent_precedence,
+        void PrintFormula(std::string& out, ExprPrecedence parent_precedence,
             bool right_child = false) const {
             auto precedence = GetPrecedence();
             auto mask = right_child ? PR_RIGHT : PR_LEFT;
             bool parens_needed = PRECEDENCE_RULES[parent_precedence][precedence] & mask;
             if (parens_needed) {
-                out << '(';
+                out += '(';
             }
 
             DoPrintFormula(out, precedence);
 
             if (parens_needed) {
-                out << ')';
+                out += ')';
             }
         }
     };
 
     namespace {
+        void Simplify(std::unique_ptr<Expr>& expr, bool& changed) {
+            if (auto simplified = expr->Simplify(changed)) {
+                expr = std::move(simplified);
+                changed = true;
+            }
+        }
+
         class BinaryOpExpr final : public Expr {
         public:
             enum Type : char {
@@ -119,9 +169,9 @@ namespace ASTImpl {
                 out << ')';
             }
 
-            void DoPrintFormula(std::ostream& out, ExprPrecedence precedence) const override {
+            void DoPrintFormula(std::string& out, ExprPrecedence precedence) const override {
                 lhs_->PrintFormula(out, precedence);
-                out << static_cast<char>(type_);
+                out += static_cast<char>(type_);
                 rhs_->PrintFormula(out, precedence, /* right_child = */ true);
             }
 
@@ -142,56 +192,69 @@ namespace ASTImpl {
                 }
             }
 
-            double Evaluate(std::function<CellInterface::Value(Position)> cell_func) const override {
-                double result = 0;
-                try {
-                    switch (type_) {
-                    case Type::Add:
-                        if (std::isfinite(this->lhs_->Evaluate(cell_func) + this->rhs_->Evaluate(cell_func))) {
-                            result = this->lhs_->Evaluate(cell_func) + this->rhs_->Evaluate(cell_func);
-                        }
-                        else {
-                            throw FormulaError(FormulaError::Category::Div0);
-                        }
-                        break;
-                    case Type::Subtract:
-                        if (std::isfinite(this->lhs_->Evaluate(cell_func) - this->rhs_->Evaluate(cell_func))) {
-                            result = this->lhs_->Evaluate(cell_func) - this->rhs_->Evaluate(cell_func);
-                        }
-                        else {
-                            throw FormulaError(FormulaError::Category::Div0);
-                        }
-                        break;
-                    case Type::Multiply:
-                        if (std::isfinite(this->lhs_->Evaluate(cell_func) * this->rhs_->Evaluate(cell_func))) {
-                            result = this->lhs_->Evaluate(cell_func) * this->rhs_->Evaluate(cell_func);
-                        }
-                        else {
-                            throw FormulaError(FormulaError::Category::Div0);
-                        }
-                        break;
-                    case Type::Divide:
-                        if (std::isfinite(this->lhs_->Evaluate(cell_func) / this->rhs_->Evaluate(cell_func))) {
-                            result = this->lhs_->Evaluate(cell_func) / this->rhs_->Evaluate(cell_func);
-                        }
-                        else {
-                            throw FormulaError(FormulaError::Category::Div0);
-                        }
-                        break;
-                    default:
-                        break;
-                    }
-                    return result;
+            double Evaluate(const FormulaCells& cells) const override {
+                //      ,  
+                const double lhs = lhs_->Evaluate(cells);
+                const double rhs = rhs_->Evaluate(cells);
+                const double result = Apply(lhs, rhs);
+                if (!std::isfinite(result)) {
+                    throw FormulaError(FormulaError::Category::Div0);
                 }
-                catch (FormulaError& e) {
-                    throw e;
+                return result;
+            }
+
+            std::unique_ptr<Expr> Simplify(bool& changed) override;
+
+            void IndexCells(const std::vector<Position>& cells) override {
+                lhs_->IndexCells(cells);
+                rhs_->IndexCells(cells);
+            }
+
+            std::size_t GetMemoryUsage() const override {
+                return sizeof(*this) + lhs_->GetMemoryUsage() + rhs_->GetMemoryUsage();
+            }
+
+            void Compile(FormulaProgram& program) const override {
+                lhs_->Compile(program);
+                rhs_->Compile(program);
+
+                FormulaProgram::Op op;
+                switch (type_) {
+                case Type::Add:
+                    op.code = FormulaProgram::Op::Code::Add;
+                    break;
+                case Type::Subtract:
+                    op.code = FormulaProgram::Op::Code::Subtract;
+                    break;
+                case Type::Multiply:
+                    op.code = FormulaProgram::Op::Code::Multiply;
+                    break;
+                case Type::Divide:
+                    op.code = FormulaProgram::Op::Code::Divide;
+                    break;
                 }
+                program.ops.push_back(op);
             }
 
         private:
             Type type_;
             std::unique_ptr<Expr> lhs_;
             std::unique_ptr<Expr> rhs_;
+
+            double Apply(double lhs, double rhs) const {
+                switch (type_) {
+                case Type::Add:
+                    return lhs + rhs;
+                case Type::Subtract:
+                    return lhs - rhs;
+                case Type::Multiply:
+                    return lhs * rhs;
+                case Type::Divide:
+                    return lhs / rhs;
+                }
+                assert(false);
+                return 0.0;
+            }
         };
 
         class UnaryOpExpr final : public Expr {
@@ -213,8 +276,8 @@ namespace ASTImpl {
                 out << ')';
             }
 
-            void DoPrintFormula(std::ostream& out, ExprPrecedence precedence) const override {
-                out << static_cast<char>(type_);
+            void DoPrintFormula(std::string& out, ExprPrecedence precedence) const override {
+                out += static_cast<char>(type_);
                 operand_->PrintFormula(out, precedence);
             }
 
@@ -222,15 +285,15 @@ namespace ASTImpl {
                 return EP_UNARY;
             }
 
-            double Evaluate(std::function<CellInterface::Value(Position)> cell_func) const override {
+            double Evaluate(const FormulaCells& cells) const override {
                 double result = 0;
 
                 switch (type_) {
                 case Type::UnaryPlus:
-                    result = this->operand_->Evaluate(cell_func);
+                    result = this->operand_->Evaluate(cells);
                     break;
                 case Type::UnaryMinus:
-                    result = -this->operand_->Evaluate(cell_func);
+                    result = -this->operand_->Evaluate(cells);
                     break;
                 default:
                     break;
@@ -239,6 +302,25 @@ namespace ASTImpl {
                 return result;
             }
 
+            void Compile(FormulaProgram& program) const override {
+                operand_->Compile(program);
+                if (type_ == Type::UnaryMinus) {
+                    FormulaProgram::Op op;
+                    op.code = FormulaProgram::Op::Code::Negate;
+                    program.ops.push_back(op);
+                }
+            }
+
+            std::unique_ptr<Expr> Simplify(bool& changed) override;
+
+            void IndexCells(const std::vector<Position>& cells) override {
+                operand_->IndexCells(cells);
+            }
+
+            std::size_t GetMemoryUsage() const override {
+                return sizeof(*this) + operand_->GetMemoryUsage();
+            }
+
         private:
             Type type_;
             std::unique_ptr<Expr> operand_;
@@ -246,35 +328,46 @@ namespace ASTImpl {
 
         class CellExpr final : public Expr {
         public:
-            explicit CellExpr(const Position* cell)
+            explicit CellExpr(Position cell)
                 : cell_(cell) {
             }
 
             void Print(std::ostream& out) const override {
-                if (!cell_->IsValid()) {
+                if (!cell_.IsValid()) {
                     out << FormulaError::Category::Ref;
                 }
                 else {
-                    out << cell_->ToString();
+                    Position::Buffer buffer;
+                    out << cell_.ToString(buffer);
                 }
             }
 
-            void DoPrintFormula(std::ostream& out, ExprPrecedence /* precedence */) const override {
-                Print(out);
+            void DoPrintFormula(std::string& out, ExprPrecedence /* precedence */) const override {
+                if (!cell_.IsValid()) {
+                    out += FormulaError(FormulaError::Category::Ref).ToString();
+                }
+                else {
+                    Position::Buffer buffer;
+                    out += cell_.ToString(buffer);
+                }
             }
 
             ExprPrecedence GetPrecedence() const override {
                 return EP_ATOM;
             }
 
-            double Evaluate(std::function<CellInterface::Value(Position)> cell_func) const override {
-                auto result = cell_func(*cell_);
+            double Evaluate(const FormulaCells& cells) const override {
+                const CellInterface* cell = cells[index_];
+                if (!cell) {
+                    return 0.0;
+                }
+                auto result = cell->GetValueView();
                 if (std::holds_alternative<FormulaError>(result)) {
                     throw std::get<FormulaError>(result);
                 }
-                if (std::holds_alternative<std::string>(result)) {
+                if (std::holds_alternative<std::string_view>(result)) {
                     //    0  
-                    if (std::get<std::string>(result).empty()) {
+                    if (std::get<std::string_view>(result).empty()) {
                         return 0.0;
                     }
                     else {
@@ -284,8 +377,29 @@ namespace ASTImpl {
                 return std::get<double>(result);                               
             }
 
+            void Compile(FormulaProgram& program) const override {
+                FormulaProgram::Op op;
+                op.code = FormulaProgram::Op::Code::Cell;
+                op.cell = cell_;
+                program.ops.push_back(op);
+            }
+
+            std::unique_ptr<Expr> Simplify(bool& /* changed */) override {
+                return nullptr;
+            }
+
+            void IndexCells(const std::vector<Position>& cells) override {
+                index_ = std::lower_bound(cells.begin(), cells.end(), cell_) - cells.begin();
+            }
+
+            std::size_t GetMemoryUsage() const override {
+                return sizeof(*this);
+            }
+
         private:
-            const Position* cell_;
+            Position cell_;
+            //      
+            std::size_t index_ = 0;
         };
 
         class NumberExpr final : public Expr {
@@ -298,22 +412,90 @@ namespace ASTImpl {
                 out << value_;
             }
 
-            void DoPrintFormula(std::ostream& out, ExprPrecedence /* precedence */) const override {
-                out << value_;
+            void DoPrintFormula(std::string& out, ExprPrecedence /* precedence */) const override {
+                //   ,     double    
+                char buffer[32];
+                const int length = std::snprintf(buffer, sizeof(buffer), "%g", value_);
+                out.append(buffer, length);
             }
 
             ExprPrecedence GetPrecedence() const override {
                 return EP_ATOM;
             }
 
-            double Evaluate(std::function<CellInterface::Value(Position)>) const override {
+            double Evaluate(const FormulaCells& /* cells */) const override {
                 return value_;
             }
 
+            void Compile(FormulaProgram& program) const override {
+                FormulaProgram::Op op;
+                op.code = FormulaProgram::Op::Code::Number;
+                op.number = value_;
+                program.ops.push_back(op);
+            }
+
+            std::unique_ptr<Expr> Simplify(bool& /* changed */) override {
+                return nullptr;
+            }
+
+            std::optional<double> GetConstant() const override {
+                return value_;
+            }
+
+            void IndexCells(const std::vector<Position>& /* cells */) override {
+            }
+
+            std::size_t GetMemoryUsage() const override {
+                return sizeof(*this);
+            }
+
         private:
             double value_;
         };
 
+        std::unique_ptr<Expr> BinaryOpExpr::Simplify(bool& changed) {
+            ASTImpl::Simplify(lhs_, changed);
+            ASTImpl::Simplify(rhs_, changed);
+
+            const auto lhs = lhs_->GetConstant();
+            const auto rhs = rhs_->GetConstant();
+            if (lhs && rhs) {
+                //    :    
+                const double result = Apply(*lhs, *rhs);
+                return std::isfinite(result) ? std::make_unique<NumberExpr>(result) : nullptr;
+            }
+
+            //      ,  x*1, x/1  x-0
+            //  x,   x  . x+0  : -0+0  +0
+            const bool is_one = rhs == 1.0;
+            const bool is_zero = rhs == 0.0 && !std::signbit(*rhs);
+            if (((type_ == Type::Multiply || type_ == Type::Divide) && is_one)
+                || (type_ == Type::Subtract && is_zero)) {
+                return std::move(lhs_);
+            }
+            if (type_ == Type::Multiply && lhs == 1.0) {
+                return std::move(rhs_);
+            }
+            return nullptr;
+        }
+
+        std::unique_ptr<Expr> UnaryOpExpr::Simplify(bool& changed) {
+            ASTImpl::Simplify(operand_, changed);
+
+            if (type_ == Type::UnaryPlus) {
+                return std::move(operand_);
+            }
+            if (const auto value = operand_->GetConstant()) {
+                return std::make_unique<NumberExpr>(-*value);
+            }
+            // -(-x) == x,     
+            auto* inner = dynamic_cast<UnaryOpExpr*>(operand_.get());
+            if (inner && inner->type_ == Type::UnaryMinus) {
+                return std::move(inner->operand_);
+            }
+            return nullptr;
+        }
+
         class ParseASTListener final : public FormulaBaseListener {
         public:
             std::unique_ptr<Expr> MoveRoot() {
@@ -324,7 +506,7 @@ namespace ASTImpl {
                 return root;
             }
 
-            std::forward_list<Position> MoveCells() {
+            std::vector<Position> MoveCells() {
                 return std::move(cells_);
             }
 
@@ -367,8 +549,8 @@ namespace ASTImpl {
                     throw FormulaException("Invalid position: " + value_str);
                 }
 
-                cells_.push_front(value);
-                auto node = std::make_unique<CellExpr>(&cells_.front());
+                cells_.push_back(value);
+                auto node = std::make_unique<CellExpr>(value);
                 args_.push_back(std::move(node));
             }
 
@@ -405,7 +587,7 @@ namespace ASTImpl {
 
         private:
             std::vector<std::unique_ptr<Expr>> args_;
-            std::forward_list<Position> cells_;
+            std::vector<Position> cells_;
         };
 
         class BailErrorListener : public antlr4::BaseErrorListener {
@@ -418,41 +600,62 @@ namespace ASTImpl {
             }
         };
 
-    }  // namespace
-}  // namespace ASTImpl
-
-FormulaAST ParseFormulaAST(std::istream& in) {
-    using namespace antlr4;
+        //  , ,        
+        //       . 
+        // ANTLR  ,      , 
+        //  DFA      
+        class ParserContext {
+        public:
+            ParserContext()
+                : lexer_(&input_)
+                , tokens_(&lexer_)
+                , parser_(&tokens_) {
+                lexer_.removeErrorListeners();
+                lexer_.addErrorListener(&error_listener_);
+                parser_.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+                parser_.removeErrorListeners();
+            }
 
-    ANTLRInputStream input(in);
+            FormulaAST Parse(const std::string& text) {
+                //   set*  ,    
+                //  ,  .  
+                //     
+                input_.load(text, false);
+                lexer_.setInputStream(&input_);
+                tokens_.setTokenSource(&lexer_);
+                parser_.setTokenStream(&tokens_);
 
-    FormulaLexer lexer(&input);
-    ASTImpl::BailErrorListener error_listener;
-    lexer.removeErrorListeners();
-    lexer.addErrorListener(&error_listener);
+                antlr4::tree::ParseTree* tree = parser_.main();
+                ParseASTListener listener;
+                antlr4::tree::ParseTreeWalker::DEFAULT.walk(&listener, tree);
 
-    CommonTokenStream tokens(&lexer);
+                return FormulaAST(listener.MoveRoot(), listener.MoveCells());
+            }
 
-    FormulaParser parser(&tokens);
-    auto error_handler = std::make_shared<BailErrorStrategy>();
-    parser.setErrorHandler(error_handler);
-    parser.removeErrorListeners();
+        private:
+            antlr4::ANTLRInputStream input_;
+            BailErrorListener error_listener_;
+            FormulaLexer lexer_;
+            antlr4::CommonTokenStream tokens_;
+            FormulaParser parser_;
+        };
 
-    tree::ParseTree* tree = parser.main();
-    ASTImpl::ParseASTListener listener;
-    tree::ParseTreeWalker::DEFAULT.walk(&listener, tree);
+    }  // namespace
+}  // namespace ASTImpl
 
-    return FormulaAST(listener.MoveRoot(), listener.MoveCells());
+FormulaAST ParseFormulaAST(std::istream& in) {
+    return ParseFormulaAST(std::string(std::istreambuf_iterator<char>(in), {}));
 }
 
 FormulaAST ParseFormulaAST(const std::string& in_str) {
-    std::istringstream in(in_str);
-    return ParseFormulaAST(in);
+    thread_local ASTImpl::ParserContext context;
+    return context.Parse(in_str);
 }
 
 void FormulaAST::PrintCells(std::ostream& out) const {
+    Position::Buffer buffer;
     for (auto cell : cells_) {
-        out << cell.ToString() << ' ';
+        out << cell.ToString(buffer) << ' ';
     }
 }
 
@@ -461,17 +664,53 @@ void FormulaAST::Print(std::ostream& out) const {
 }
 
 void FormulaAST::PrintFormula(std::ostream& out) const {
-    root_expr_->PrintFormula(out, ASTImpl::EP_ATOM);
+    out << GetExpression();
+}
+
+std::string FormulaAST::GetExpression() const {
+    if (!expression_.empty()) {
+        return expression_;
+    }
+    std::string expression;
+    root_expr_->PrintFormula(expression, ASTImpl::EP_ATOM);
+    return expression;
+}
+
+FormulaProgram FormulaAST::GetProgram() const {
+    FormulaProgram program;
+    root_expr_->Compile(program);
+    return program;
+}
+
+std::size_t FormulaAST::GetMemoryUsage() const {
+    return root_expr_->GetMemoryUsage() + Memory::HeapSize(cells_) + Memory::HeapSize(expression_);
 }
 
-double FormulaAST::Execute(std::function<CellInterface::Value(Position)> cell_func) const {
-    return root_expr_->Evaluate(cell_func);
+double FormulaAST::Execute(const std::vector<const CellInterface*>& cells) const {
+    return root_expr_->Evaluate(ASTImpl::FormulaCells(cells));
 }
 
-FormulaAST::FormulaAST(std::unique_ptr<ASTImpl::Expr> root_expr, std::forward_list<Position> cells)
+double FormulaAST::Execute(const SheetInterface& sheet) const {
+    return root_expr_->Evaluate(ASTImpl::FormulaCells(sheet, cells_));
+}
+
+FormulaAST::FormulaAST(std::unique_ptr<ASTImpl::Expr> root_expr, std::vector<Position> cells)
     : root_expr_(std::move(root_expr))
     , cells_(std::move(cells)) {
-    cells_.sort();  // to avoid sorting in GetReferencedCells
+    // to avoid sorting in GetReferencedCells
+    std::sort(cells_.begin(), cells_.end());
+    cells_.erase(std::unique(cells_.begin(), cells_.end()), cells_.end());
+    cells_.shrink_to_fit();
+
+    //    ,  , 
+    // ,   
+    std::string expression = GetExpression();
+    bool changed = false;
+    ASTImpl::Simplify(root_expr_, changed);
+    if (changed) {
+        expression_ = std::move(expression);
+    }
+    root_expr_->IndexCells(cells_);
 }
 
 FormulaAST::~FormulaAST() = default;
\ No newline at end of file
@@ -3,9 +3,9 @@
 #include "FormulaLexer.h"
 #include "common.h"
 
-#include <forward_list>
 #include <functional>
 #include <stdexcept>
+#include <vector>
 
 namespace ASTImpl {
     class Expr;
@@ -15,24 +15,53 @@ class ParsingError : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
+// The formula in postfix order, ready to be executed on a stack machine
+// many times without walking the AST
+struct FormulaProgram {
+    struct Op {
+        enum class Code : char {
+            Number,    // push number
+            Cell,      // push value of cell
+            Add,
+            Subtract,
+            Multiply,
+            Divide,
+            Negate,
+        };
+
+        Code code = Code::Number;
+        double number = 0.0;
+        Position cell;
+    };
+
+    std::vector<Op> ops;
+};
+
 class FormulaAST {
 public:
     explicit FormulaAST(std::unique_ptr<ASTImpl::Expr> root_expr,
-        std::forward_list<Position> cells);
+        std::vector<Position> cells);
     FormulaAST(FormulaAST&&) = default;
     FormulaAST& operator=(FormulaAST&&) = default;
     ~FormulaAST();
 
-    double Execute(std::function<CellInterface::Value(Position)> cell_func) const;
+    // cells[i] is the cell at GetCells()[i] or nullptr if there is no such cell
+    double Execute(const std::vector<const CellInterface*>& cells) const;
+    // Looks the cells up on the sheet while executing, without building a list
+    double Execute(const SheetInterface& sheet) const;
     void PrintCells(std::ostream& out) const;
     void Print(std::ostream& out) const;
     void PrintFormula(std::ostream& out) const;
+    // Same text as PrintFormula, built without streams. Constant folding
+    // does not affect it: the text is the one the user wrote
+    std::string GetExpression() const;
+    FormulaProgram GetProgram() const;
+    // Heap memory of the tree, the cell list and the kept text, without
+    // sizeof(FormulaAST) itself
+    std::size_t GetMemoryUsage() const;
 
-    std::forward_list<Position>& GetCells() {
-        return cells_;
-    }
-
-    const std::forward_list<Position>& GetCells() const {
+    // Sorted, without duplicates
+    const std::vector<Position>& GetCells() const {
         return cells_;
     }
 
@@ -42,7 +71,11 @@ private:
     // physically stores cells so that they can be
     // efficiently traversed without going through
     // the whole AST
-    std::forward_list<Position> cells_;
+    std::vector<Position> cells_;
+
+    // canonical text of the formula as written; kept only when
+    // root_expr_ was simplified and would print differently
+    std::string expression_;
 };
 
 FormulaAST ParseFormulaAST(std::istream& in);
@@ -0,0 +1,67 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+	std::atomic<std::size_t> allocated_bytes{ 0 };
+	std::atomic<std::size_t> allocation_count{ 0 };
+
+	// Перед каждым блоком хранится его размер, чтобы учитывать освобождение
+	constexpr std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+	void* Allocate(std::size_t size) {
+		void* block = std::malloc(size + HEADER_SIZE);
+		if (!block) {
+			throw std::bad_alloc();
+		}
+		*static_cast<std::size_t*>(block) = size;
+		allocated_bytes += size;
+		++allocation_count;
+		return static_cast<char*>(block) + HEADER_SIZE;
+	}
+
+	void Deallocate(void* ptr) noexcept {
+		if (!ptr) {
+			return;
+		}
+		void* block = static_cast<char*>(ptr) - HEADER_SIZE;
+		allocated_bytes -= *static_cast<std::size_t*>(block);
+		std::free(block);
+	}
+} // namespace
+
+namespace AllocCounter {
+	std::size_t GetAllocatedBytes() {
+		return allocated_bytes;
+	}
+
+	std::size_t GetAllocationCount() {
+		return allocation_count;
+	}
+} // namespace AllocCounter
+
+void* operator new(std::size_t size) {
+	return Allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+	return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	Deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+	Deallocate(ptr);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+// Счётчики динамической памяти процесса. Работают за счёт замены глобальных
+// operator new/delete в alloc_counter.cpp
+namespace AllocCounter {
+    // Сколько байт выделено в данный момент
+    std::size_t GetAllocatedBytes();
+    // Сколько раз выделялась память за всё время работы
+    std::size_t GetAllocationCount();
+}
@@ -0,0 +1,133 @@
+#include "alloc_counter.h"
+#include "benchmarks.h"
+#include "log_duration.h"
+
+#include "sheet.h"
+#include "workload.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+void BenchNumericCellsMemory(double scale) {
+	const int cols = 1000;
+	const int rows = static_cast<int>(10'000 * scale);
+
+	const std::size_t bytes_before = AllocCounter::GetAllocatedBytes();
+	{
+		Sheet sheet;
+		{
+			LOG_DURATION("SetCell x " + std::to_string(rows * cols) + " numbers");
+			for (int row = 0; row < rows; ++row) {
+				for (int col = 0; col < cols; ++col) {
+					sheet.SetCell({ row, col }, std::to_string(row * cols + col));
+				}
+			}
+		}
+
+		const std::size_t bytes = AllocCounter::GetAllocatedBytes() - bytes_before;
+		std::cerr << "sizeof(Cell): " << sizeof(Cell) << " bytes" << std::endl;
+		std::cerr << "Sheet memory: " << bytes / (1024 * 1024) << " MiB, "
+			<< static_cast<double>(bytes) / (static_cast<double>(rows) * cols) << " bytes per cell" << std::endl;
+	}
+}
+
+void BenchFormulaCellsMemory(double scale) {
+	const int cols = 100;
+	const int rows = static_cast<int>(10'000 * scale);
+
+	const std::size_t bytes_before = AllocCounter::GetAllocatedBytes();
+	{
+		Sheet sheet;
+		for (int row = 0; row < rows; ++row) {
+			sheet.SetCell({ row, 0 }, std::to_string(row));
+		}
+		const std::size_t numbers_bytes = AllocCounter::GetAllocatedBytes() - bytes_before;
+		{
+			LOG_DURATION("SetCell x " + std::to_string(rows * (cols - 1)) + " formulas");
+			for (int row = 0; row < rows; ++row) {
+				const std::string input = "A" + std::to_string(row + 1);
+				for (int col = 1; col < cols; ++col) {
+					sheet.SetCell({ row, col }, "=" + input + "*" + std::to_string(col));
+				}
+			}
+		}
+
+		const std::size_t bytes = AllocCounter::GetAllocatedBytes() - bytes_before - numbers_bytes;
+		std::cerr << "sizeof(FormulaImpl): " << sizeof(CellImpl::FormulaImpl) << " bytes" << std::endl;
+		std::cerr << "Formulas memory: " << bytes / (1024 * 1024) << " MiB, "
+			<< static_cast<double>(bytes) / (static_cast<double>(rows) * (cols - 1)) << " bytes per formula" << std::endl;
+	}
+}
+
+void BenchCloneMemory(double scale) {
+	const int cols = 100;
+	const int rows = static_cast<int>(10'000 * scale);
+	const int clones = 10;
+	const int edits = 100;
+
+	Sheet sheet;
+	const std::size_t bytes_before = AllocCounter::GetAllocatedBytes();
+	for (int row = 0; row < rows; ++row) {
+		for (int col = 0; col + 1 < cols; ++col) {
+			sheet.SetCell({ row, col }, std::to_string(row * cols + col));
+		}
+		// Последний столбец - формула от первых ячеек строки
+		const std::string row_number = std::to_string(row + 1);
+		sheet.SetCell({ row, cols - 1 }, "=A" + row_number + "*B" + row_number + "+C" + row_number);
+	}
+	const std::size_t sheet_bytes = AllocCounter::GetAllocatedBytes() - bytes_before;
+	std::cerr << "Sheet of " << rows * cols << " cells: " << sheet_bytes / (1024 * 1024) << " MiB" << std::endl;
+
+	std::vector<std::unique_ptr<Sheet>> copies;
+	{
+		LOG_DURATION("Clone() x " + std::to_string(clones));
+		for (int i = 0; i < clones; ++i) {
+			copies.push_back(sheet.Clone());
+		}
+	}
+	{
+		LOG_DURATION("SetCell x " + std::to_string(edits) + " in each clone");
+		for (int i = 0; i < clones; ++i) {
+			// Правки сосредоточены в одном месте листа, как при изменении входных данных
+			for (int edit = 0; edit < edits; ++edit) {
+				copies[i]->SetCell({ edit, i % 3 }, std::to_string(edit + i));
+			}
+		}
+	}
+	const std::size_t clones_bytes = AllocCounter::GetAllocatedBytes() - bytes_before - sheet_bytes;
+	std::cerr << clones << " clones with " << edits << " edits: " << clones_bytes / 1024 << " KiB, "
+		<< static_cast<double>(clones_bytes) / sheet_bytes * 100 / clones << "% of the sheet per clone" << std::endl;
+}
+
+void BenchMemoryAccounting(double scale) {
+	const int cells = static_cast<int>(200'000 * scale);
+	WorkloadGenerator generator(1);
+	const auto layout = generator.Layout({ Position::MAX_ROWS, 50 }, 0.1);
+	const auto dag = generator.RandomDag({ Position::MAX_ROWS, 50 }, cells, 0.5, 4);
+
+	const std::size_t bytes_before = AllocCounter::GetAllocatedBytes();
+	{
+		Sheet sheet;
+		ApplyWorkload(sheet, layout);
+		ApplyWorkload(sheet, dag);
+		sheet.PublishValues();
+		const std::size_t bytes = AllocCounter::GetAllocatedBytes() - bytes_before;
+
+		Sheet::MemoryUsage usage;
+		{
+			LOG_DURATION("GetMemoryUsage() x 1000");
+			for (int i = 0; i < 1000; ++i) {
+				usage = sheet.GetMemoryUsage();
+			}
+		}
+		const auto mib = [](std::size_t bytes) {
+			return static_cast<double>(bytes) / (1024 * 1024);
+		};
+		std::cerr << "cells " << mib(usage.cells) << " MiB, texts " << mib(usage.texts)
+			<< " MiB, formulas " << mib(usage.formulas) << " MiB, dependencies " << mib(usage.dependencies)
+			<< " MiB, values " << mib(usage.values) << " MiB" << std::endl;
+		std::cerr << "Estimated " << mib(usage.GetTotal()) << " MiB, allocated " << mib(bytes) << " MiB" << std::endl;
+	}
+}
@@ -0,0 +1,49 @@
+#include "benchmarks.h"
+#include "log_duration.h"
+
+#include "cell.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+void BenchNumberParsing(double scale) {
+	const std::size_t total = static_cast<std::size_t>(10'000'000 * scale);
+	const std::size_t unique = std::min<std::size_t>(total, 1'000'000);
+
+	// Целые, дробные и числа с экспонентой, как при импорте числовых столбцов
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+	std::vector<std::string> strings;
+	strings.reserve(unique);
+	for (std::size_t i = 0; i < unique; ++i) {
+		const double value = distribution(generator);
+		switch (i % 3) {
+		case 0:
+			strings.push_back(std::to_string(static_cast<long long>(value)));
+			break;
+		case 1:
+			strings.push_back(std::to_string(value));
+			break;
+		default:
+			char buffer[32];
+			std::snprintf(buffer, sizeof(buffer), "%.6e", value);
+			strings.push_back(buffer);
+			break;
+		}
+	}
+
+	double sum = 0.0;
+	{
+		LOG_DURATION("ParseNumber x " + std::to_string(total));
+		for (std::size_t i = 0; i < total; ++i) {
+			if (auto value = CellImpl::ParseNumber(strings[i % unique])) {
+				sum += *value;
+			}
+		}
+	}
+	std::cerr << "checksum: " << sum << std::endl;
+}
@@ -0,0 +1,129 @@
+#include "benchmarks.h"
+#include "log_duration.h"
+
+#include "formula.h"
+#include "sheet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	// Разбирает каждую формулу и выводит медиану, 99-й перцентиль и максимум
+	// времени разбора одной формулы в микросекундах
+	std::size_t ReportLatency(const std::string& id, const std::vector<std::string>& formulas) {
+		std::vector<double> latencies;
+		latencies.reserve(formulas.size());
+		std::size_t cells = 0;
+		for (const std::string& formula : formulas) {
+			const auto start = Clock::now();
+			cells += ParseFormula(formula)->GetReferencedCells().size();
+			latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+		auto percentile = [&latencies](double p) {
+			return latencies[static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1))];
+		};
+		std::cerr << id << " x " << formulas.size() << ": p50 " << percentile(0.5) << " us, p99 "
+			<< percentile(0.99) << " us, max " << latencies.back() << " us" << std::endl;
+		return cells;
+	}
+
+	// Формулы одной из нескольких форм с разными ячейками и числами
+	std::vector<std::string> MakeFormulas(std::size_t count, int seed) {
+		std::vector<std::string> formulas;
+		formulas.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			const std::string row = std::to_string(i % 1000 + seed);
+			const std::string number = std::to_string(i % 97) + "." + std::to_string(seed);
+			switch ((i + seed) % 4) {
+			case 0:
+				formulas.push_back("A" + row + "*" + number);
+				break;
+			case 1:
+				formulas.push_back("(B" + row + "+C" + row + ")/" + number + "e2");
+				break;
+			case 2:
+				formulas.push_back("-D" + row + "-" + number + "*(E1+F" + row + ")");
+				break;
+			default:
+				formulas.push_back("G" + row + "/H" + row + "+I" + row + "*J" + row + "-" + number);
+				break;
+			}
+		}
+		return formulas;
+	}
+} // namespace
+
+void BenchFormulaParsing(double scale) {
+	const std::size_t parses = static_cast<std::size_t>(200'000 * scale);
+
+	// Первые формулы процесса строят состояния DFA лексера и парсера по ходу разбора
+	std::size_t cells = ReportLatency("cold", MakeFormulas(8, 1));
+	{
+		LOG_DURATION("WarmUpFormulaParser");
+		WarmUpFormulaParser();
+	}
+	// Формулы, которые ещё не встречались, но после прогрева
+	cells += ReportLatency("warm, new formulas", MakeFormulas(8, 2));
+	cells += ReportLatency("warm", MakeFormulas(parses, 3));
+	std::cerr << "referenced cells: " << cells << std::endl;
+}
+
+void BenchParallelParsing(double scale) {
+	const std::size_t count = static_cast<std::size_t>(400'000 * scale);
+	const auto expressions = MakeFormulas(count, 4);
+	WarmUpFormulaParser();
+
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<unsigned> thread_counts;
+	for (unsigned threads = 1; threads < cores; threads *= 2) {
+		thread_counts.push_back(threads);
+	}
+	thread_counts.push_back(cores);
+
+	std::size_t cells = 0;
+	for (unsigned threads : thread_counts) {
+		std::vector<std::unique_ptr<FormulaInterface>> formulas;
+		{
+			LOG_DURATION("ParseFormulas x " + std::to_string(count) + ", threads: " + std::to_string(threads));
+			formulas = ParseFormulas(expressions, threads);
+		}
+		for (const auto& formula : formulas) {
+			cells += formula->GetReferencedCells().size();
+		}
+	}
+
+	// Загрузка листа: числа в столбце A и формулы над ними в столбцах B:E
+	const int rows = std::min(static_cast<int>(16'000 * scale), Position::MAX_ROWS);
+	std::vector<std::pair<Position, std::string>> texts;
+	for (int row = 0; row < rows; ++row) {
+		const std::string row_number = std::to_string(row + 1);
+		texts.push_back({ { row, 0 }, std::to_string(row % 1000) });
+		texts.push_back({ { row, 1 }, "=A" + row_number + "*2" });
+		texts.push_back({ { row, 2 }, "=(A" + row_number + "+B" + row_number + ")/3" });
+		texts.push_back({ { row, 3 }, "=-C" + row_number + "-1.5*(A" + row_number + "+1)" });
+		texts.push_back({ { row, 4 }, "=D" + row_number + "/B" + row_number + "+A1" });
+	}
+	{
+		LOG_DURATION("SetCell x " + std::to_string(texts.size()));
+		Sheet sheet;
+		for (const auto& [pos, text] : texts) {
+			sheet.SetCell(pos, text);
+		}
+	}
+	{
+		LOG_DURATION("SetCells x " + std::to_string(texts.size()) + ", threads: " + std::to_string(cores));
+		Sheet sheet;
+		sheet.SetCells(texts, cores);
+	}
+	std::cerr << "referenced cells: " << cells << std::endl;
+}
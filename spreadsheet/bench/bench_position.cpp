@@ -0,0 +1,49 @@
+#include "benchmarks.h"
+#include "log_duration.h"
+
+#include "common.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+void BenchPositionConversion(double scale) {
+	const int total = static_cast<int>(10'000'000 * scale);
+
+	// Позиции по всему листу, в том числе с трёхбуквенными столбцами
+	std::vector<Position> positions;
+	positions.reserve(total);
+	for (int i = 0; i < total; ++i) {
+		positions.push_back({ static_cast<int>(i * 7919LL % Position::MAX_ROWS), static_cast<int>(i * 104729LL % Position::MAX_COLS) });
+	}
+
+	std::size_t length = 0;
+	{
+		LOG_DURATION("ToString() x " + std::to_string(total));
+		for (Position pos : positions) {
+			length += pos.ToString().size();
+		}
+	}
+
+	std::vector<std::string> texts;
+	texts.reserve(total);
+	{
+		LOG_DURATION("ToString(buffer) x " + std::to_string(total));
+		Position::Buffer buffer;
+		for (Position pos : positions) {
+			length += pos.ToString(buffer).size();
+		}
+	}
+	for (Position pos : positions) {
+		texts.push_back(pos.ToString());
+	}
+
+	std::size_t checksum = 0;
+	{
+		LOG_DURATION("FromString x " + std::to_string(total));
+		for (const std::string& text : texts) {
+			checksum += Position::FromString(text).col;
+		}
+	}
+	std::cerr << "checksum: " << length + checksum << std::endl;
+}
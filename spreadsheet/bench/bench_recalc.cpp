@@ -0,0 +1,120 @@
+#include "benchmarks.h"
+#include "log_duration.h"
+
+#include "sheet.h"
+
+#include <iostream>
+#include <string>
+
+void BenchSmallDeltaRecalc(double scale) {
+	const int rows = static_cast<int>(10'000 * scale);
+	const int chain = 8;
+
+	// В каждой строке входное число и цепочка формул от него. Первая формула
+	// ограничивает значение сверху, как это часто бывает в расчётах
+	Sheet sheet;
+	for (int row = 0; row < rows; ++row) {
+		const std::string row_number = std::to_string(row + 1);
+		sheet.SetCell({ row, 0 }, std::to_string(row % 100));
+		sheet.SetCell({ row, 1 }, "=A" + row_number + "*0+1");
+		for (int col = 2; col < chain + 1; ++col) {
+			sheet.SetCell({ row, col }, "=" + Position{ row, col - 1 }.ToString() + "*2+1");
+		}
+	}
+
+	auto report = [&sheet](Sheet::RecalcStats before) {
+		const auto stats = sheet.GetRecalcStats();
+		std::cerr << "evaluated: " << stats.evaluated - before.evaluated
+			<< ", skipped: " << stats.skipped - before.skipped << std::endl;
+	};
+
+	auto stats = sheet.GetRecalcStats();
+	{
+		LOG_DURATION("Rewrite " + std::to_string(rows) + " inputs with the same values");
+		for (int row = 0; row < rows; ++row) {
+			sheet.SetCell({ row, 0 }, std::to_string(row % 100));
+		}
+	}
+	report(stats);
+
+	stats = sheet.GetRecalcStats();
+	{
+		LOG_DURATION("Change " + std::to_string(rows) + " inputs, values clamped by the first formula");
+		for (int row = 0; row < rows; ++row) {
+			sheet.SetCell({ row, 0 }, std::to_string(row % 100 + 1));
+		}
+	}
+	report(stats);
+}
+
+void BenchFormulaRecalc(double scale) {
+	const int formulas = 1'000;
+	const int changes = static_cast<int>(1'000 * scale);
+
+	Sheet sheet;
+	sheet.SetCell({ 0, 0 }, "0");
+	for (int row = 0; row < formulas; ++row) {
+		sheet.SetCell({ row, 1 }, "=A1*" + std::to_string(row + 1) + "+(A1-1)/2");
+	}
+
+	const auto stats = sheet.GetRecalcStats();
+	{
+		LOG_DURATION("Change the input " + std::to_string(changes) + " times, "
+			+ std::to_string(formulas) + " dependent formulas");
+		for (int change = 1; change <= changes; ++change) {
+			sheet.SetCell({ 0, 0 }, std::to_string(change));
+		}
+	}
+	std::cerr << "evaluated: " << sheet.GetRecalcStats().evaluated - stats.evaluated << std::endl;
+}
+
+void BenchConstantSubexpressions(double scale) {
+	const int formulas = 1'000;
+	const int changes = static_cast<int>(1'000 * scale);
+
+	Sheet sheet;
+	sheet.SetCell({ 0, 0 }, "0");
+	for (int row = 0; row < formulas; ++row) {
+		sheet.SetCell({ row, 1 }, "=+(A1/(60*60*24))*1-(-(-(" + std::to_string(row) + "*365.25/12)))");
+	}
+
+	LOG_DURATION("Change the input " + std::to_string(changes) + " times, "
+		+ std::to_string(formulas) + " dependent formulas");
+	for (int change = 1; change <= changes; ++change) {
+		sheet.SetCell({ 0, 0 }, std::to_string(change));
+	}
+}
+
+void BenchSharedSubexpressions(double scale) {
+	const int rows = static_cast<int>(5'000 * scale);
+	const int formulas = 20;
+
+	for (bool share : { false, true }) {
+		// В каждой строке формулы над одним и тем же подвыражением от входных B и C
+		Sheet sheet;
+		if (share) {
+			sheet.ShareSubexpressions();
+		}
+		for (int row = 0; row < rows; ++row) {
+			const std::string b = "B" + std::to_string(row + 1);
+			const std::string c = "C" + std::to_string(row + 1);
+			const std::string common = "(" + b + "-" + c + ")*(" + b + "+" + c + ")/(" + b + "*" + c + "+1)";
+			sheet.SetCell({ row, 1 }, std::to_string(row % 10));
+			sheet.SetCell({ row, 2 }, "3");
+			for (int col = 3; col < formulas + 3; ++col) {
+				sheet.SetCell({ row, col }, "=" + common + "*" + std::to_string(col));
+			}
+		}
+
+		{
+			LOG_DURATION(std::string(share ? "Shared" : "Separate") + " subexpressions, change "
+				+ std::to_string(rows) + " inputs with " + std::to_string(formulas) + " formulas each");
+			for (int row = 0; row < rows; ++row) {
+				sheet.SetCell({ row, 1 }, std::to_string(row % 10 + 1));
+			}
+		}
+		const auto stats = sheet.GetSubexpressionStats();
+		std::cerr << "nodes: " << stats.nodes << ", shared: " << stats.shared
+			<< ", reused: " << stats.reused << std::endl;
+	}
+}
@@ -0,0 +1,25 @@
+#include "alloc_counter.h"
+#include "benchmarks.h"
+#include "log_duration.h"
+
+#include "sheet.h"
+
+#include <iostream>
+#include <string>
+
+void BenchReferencedCells(double scale) {
+	const int depth = static_cast<int>(3'000 * scale);
+
+	// Цепочка A2=A1+1, A3=A2+1, ...: проверка циклов при добавлении каждой формулы
+	// проходит по всей цепочке и запрашивает у каждой формулы её ячейки
+	Sheet sheet;
+	sheet.SetCell({ 0, 0 }, "1");
+	const std::size_t allocations_before = AllocCounter::GetAllocationCount();
+	{
+		LOG_DURATION("SetCell x " + std::to_string(depth) + " in a chain");
+		for (int row = 1; row < depth; ++row) {
+			sheet.SetCell({ row, 0 }, "=A" + std::to_string(row) + "+1");
+		}
+	}
+	std::cerr << "allocations: " << AllocCounter::GetAllocationCount() - allocations_before << std::endl;
+}
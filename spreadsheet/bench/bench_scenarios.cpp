@@ -0,0 +1,95 @@
+#include "benchmarks.h"
+#include "log_duration.h"
+
+#include "scenario.h"
+#include "sheet.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void BenchScenarioEvaluation(double scale) {
+	const int periods = 120;
+	const int unrelated_rows = 2000;
+	const int scenarios_count = static_cast<int>(10'000 * scale);
+
+	// Модель вклада: A1 - ставка, A2 - ежемесячный взнос, в столбце B остаток по месяцам.
+	// В столбцах D:F - вычисления, не зависящие от входных ячеек
+	Sheet sheet;
+	sheet.SetCell({ 0, 0 }, "0.01");
+	sheet.SetCell({ 1, 0 }, "100");
+	sheet.SetCell({ 0, 1 }, "=A2");
+	for (int row = 1; row < periods; ++row) {
+		sheet.SetCell({ row, 1 }, "=B" + std::to_string(row) + "*(1+A1)+A2");
+	}
+	for (int row = 0; row < unrelated_rows; ++row) {
+		const std::string row_number = std::to_string(row + 1);
+		sheet.SetCell({ row, 3 }, std::to_string(row));
+		sheet.SetCell({ row, 4 }, "=D" + row_number + "*2");
+		sheet.SetCell({ row, 5 }, "=E" + row_number + "+D" + row_number);
+	}
+	const Position output{ periods - 1, 1 };
+
+	std::vector<std::vector<double>> scenarios;
+	for (int i = 0; i < scenarios_count; ++i) {
+		scenarios.push_back({ 0.001 * (i % 50), 50.0 + i % 200 });
+	}
+
+	double checksum = 0;
+	{
+		LOG_DURATION("SetCell + GetValue x " + std::to_string(scenarios_count));
+		auto clone = sheet.Clone();
+		for (const auto& scenario : scenarios) {
+			clone->SetCell({ 0, 0 }, std::to_string(scenario[0]));
+			clone->SetCell({ 1, 0 }, std::to_string(scenario[1]));
+			checksum += std::get<double>(clone->GetCell(output)->GetValue());
+		}
+	}
+
+	ScenarioEvaluator evaluator(sheet, { { 0, 0 }, { 1, 0 } }, { output });
+	std::cerr << "compiled formulas: " << evaluator.GetFormulaCount() << std::endl;
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned threads : { 1u, cores }) {
+		LOG_DURATION("ScenarioEvaluator x " + std::to_string(scenarios_count) + ", threads: " + std::to_string(threads));
+		for (const auto& results : evaluator.Evaluate(scenarios, threads)) {
+			checksum += std::get<double>(results[0]);
+		}
+	}
+	std::cerr << "checksum: " << checksum << std::endl;
+}
+
+void BenchColumnRuns(double scale) {
+	const int rows = 16'000;
+	const int scenarios_count = static_cast<int>(200 * scale);
+
+	// Протянутые вниз формулы: E = B*C-D1, F = E*2+B, входная ячейка - D1
+	Sheet sheet;
+	std::vector<Position> outputs;
+	for (int row = 0; row < rows; ++row) {
+		const std::string row_number = std::to_string(row + 1);
+		sheet.SetCell({ row, 1 }, std::to_string(row % 100));
+		sheet.SetCell({ row, 2 }, std::to_string(row % 7 + 1));
+		sheet.SetCell({ row, 4 }, "=B" + row_number + "*C" + row_number + "-D1");
+		sheet.SetCell({ row, 5 }, "=E" + row_number + "*2+B" + row_number);
+		outputs.push_back({ row, 5 });
+	}
+
+	std::vector<std::vector<double>> scenarios;
+	for (int i = 0; i < scenarios_count; ++i) {
+		scenarios.push_back({ 0.5 * i });
+	}
+
+	ScenarioEvaluator evaluator(sheet, { { 0, 3 } }, outputs);
+	std::cerr << "compiled formulas: " << evaluator.GetFormulaCount()
+		<< ", vectorized: " << evaluator.GetVectorizedCount() << std::endl;
+	double checksum = 0;
+	{
+		LOG_DURATION("ScenarioEvaluator x " + std::to_string(scenarios_count) + ", threads: 1");
+		for (const auto& results : evaluator.Evaluate(scenarios, 1)) {
+			checksum += std::get<double>(results[rows / 2]);
+		}
+	}
+	std::cerr << "checksum: " << checksum << std::endl;
+}
@@ -0,0 +1,103 @@
+#include "benchmarks.h"
+
+#include "sheet.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	constexpr int ROWS = 256;
+	constexpr int COLS = 16;
+
+	// Лист из чисел, в последнем столбце каждой строки - формула от её первых ячеек
+	void FillSheet(Sheet& sheet) {
+		for (int row = 0; row < ROWS; ++row) {
+			for (int col = 0; col + 1 < COLS; ++col) {
+				sheet.SetCell({ row, col }, std::to_string(row + col));
+			}
+			const std::string row_number = std::to_string(row + 1);
+			sheet.SetCell({ row, COLS - 1 }, "=A" + row_number + "*B" + row_number + "+C" + row_number);
+		}
+	}
+
+	Position GetReadPosition(std::size_t i) {
+		return { static_cast<int>(i * 7919 % ROWS), static_cast<int>(i * 31 % COLS) };
+	}
+
+	// Один поток пишет в лист, readers потоков читают, пока писатель не закончит.
+	// read(i) читает одно значение, write(i) выполняет одно изменение
+	template <typename ReadFunc, typename WriteFunc>
+	void RunReadWrite(const std::string& name, int readers, int writes, ReadFunc read, WriteFunc write) {
+		std::atomic<bool> stop = false;
+		std::atomic<std::size_t> total_reads = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> threads;
+		for (int reader = 0; reader < readers; ++reader) {
+			threads.emplace_back([&, reader] {
+				std::size_t reads = 0;
+				for (std::size_t i = reader; !stop; i += readers) {
+					read(i);
+					++reads;
+				}
+				total_reads += reads;
+			});
+		}
+		for (int i = 0; i < writes; ++i) {
+			write(i);
+		}
+		stop = true;
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cerr << name << ", readers: " << readers
+			<< ", reads/s: " << static_cast<std::size_t>(total_reads / seconds)
+			<< ", writes/s: " << static_cast<std::size_t>(writes / seconds) << std::endl;
+	}
+} // namespace
+
+void BenchConcurrentReads(double scale) {
+	const int writes = static_cast<int>(200'000 * scale);
+	// Снимок публикуется после каждой пачки изменений
+	const int publish_batch = 64;
+
+	for (int readers : { 0, 1, 2, 4, 8 }) {
+		Sheet sheet;
+		FillSheet(sheet);
+		std::mutex mutex;
+
+		RunReadWrite("mutex", readers, writes,
+			[&](std::size_t i) {
+				std::lock_guard guard(mutex);
+				return sheet.GetCell(GetReadPosition(i))->GetValueView();
+			},
+			[&](int i) {
+				std::lock_guard guard(mutex);
+				sheet.SetCell({ i % ROWS, i % 3 }, std::to_string(i));
+			});
+	}
+
+	for (int readers : { 0, 1, 2, 4, 8 }) {
+		Sheet sheet;
+		FillSheet(sheet);
+		sheet.PublishValues();
+
+		RunReadWrite("snapshots", readers, writes,
+			[&](std::size_t i) {
+				return sheet.ReadValues()->GetValue(GetReadPosition(i));
+			},
+			[&](int i) {
+				sheet.SetCell({ i % ROWS, i % 3 }, std::to_string(i));
+				if (i % publish_batch == publish_batch - 1) {
+					sheet.PublishValues();
+				}
+			});
+	}
+}
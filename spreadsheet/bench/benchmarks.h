@@ -0,0 +1,55 @@
+#pragma once
+
+// Бенчмарки запускаются из bench/main.cpp. Размеры задач можно уменьшить,
+// передав множитель в командной строке: spreadsheet_bench 0.1
+
+// Память, занимаемая листом из 10M числовых ячеек
+void BenchNumericCellsMemory(double scale);
+
+// Память, занимаемая листом из 1M формул
+void BenchFormulaCellsMemory(double scale);
+
+// Память, занимаемая копиями листа с небольшими правками
+void BenchCloneMemory(double scale);
+
+// Оценка памяти листа по категориям против памяти, выделенной на самом деле
+void BenchMemoryAccounting(double scale);
+
+// Разбор 10M числовых строк при создании текстовых ячеек
+void BenchNumberParsing(double scale);
+
+// Время разбора одной формулы до прогрева парсера и после него. Запускается
+// первым: до него в процессе не должно быть разобрано ни одной формулы
+void BenchFormulaParsing(double scale);
+
+// Разбор 400K формул в 1..N потоках и загрузка листа с параллельным разбором
+void BenchParallelParsing(double scale);
+
+// Преобразование позиций в текст и обратно
+void BenchPositionConversion(double scale);
+
+// Пропускная способность чтения значений из нескольких потоков во время
+// изменения листа: общий мьютекс против опубликованных снимков
+void BenchConcurrentReads(double scale);
+
+// Вычисление листа для множества наборов входных данных: пересчёт через SetCell
+// против скомпилированного подграфа
+void BenchScenarioEvaluation(double scale);
+
+// Вычисление подграфа из двух столбцов по 16K протянутых формул
+void BenchColumnRuns(double scale);
+
+// Пересчёт зависимых формул при небольших изменениях входных ячеек
+void BenchSmallDeltaRecalc(double scale);
+
+// 1M пересчётов формул, зависящих от одной входной ячейки
+void BenchFormulaRecalc(double scale);
+
+// Пересчёт импортированных формул с константными подвыражениями и лишними знаками
+void BenchConstantSubexpressions(double scale);
+
+// Пересчёт строк с повторяющимся подвыражением: без пула подвыражений и с ним
+void BenchSharedSubexpressions(double scale);
+
+// Проверка циклических зависимостей на длинной цепочке формул
+void BenchReferencedCells(double scale);
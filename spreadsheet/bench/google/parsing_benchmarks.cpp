@@ -0,0 +1,56 @@
+#include "formula.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	std::vector<std::string> MakeExpressions(std::size_t count) {
+		std::vector<std::string> expressions;
+		expressions.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			const std::string row = std::to_string(i % 1000 + 1);
+			switch (i % 3) {
+			case 0:
+				expressions.push_back("A" + row + "*" + std::to_string(i % 97));
+				break;
+			case 1:
+				expressions.push_back("(B" + row + "+C" + row + ")/1.5e2-D1");
+				break;
+			default:
+				expressions.push_back("-E" + row + "-2*(F1+G" + row + ")/H" + row);
+				break;
+			}
+		}
+		return expressions;
+	}
+
+	void BM_ParseFormula(benchmark::State& state) {
+		WarmUpFormulaParser();
+		const auto expressions = MakeExpressions(1000);
+		std::size_t i = 0;
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(ParseFormula(expressions[i++ % expressions.size()]));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_ParseFormula);
+
+	// Разбор пачки из 10K формул в заданном числе потоков
+	void BM_ParseFormulas(benchmark::State& state) {
+		WarmUpFormulaParser();
+		const auto expressions = MakeExpressions(10'000);
+		const unsigned threads = static_cast<unsigned>(state.range(0));
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(ParseFormulas(expressions, threads));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(expressions.size()));
+	}
+	BENCHMARK(BM_ParseFormulas)
+		->RangeMultiplier(2)
+		->Range(1, static_cast<int64_t>(std::max(1u, std::thread::hardware_concurrency())))
+		->UseRealTime();
+} // namespace
@@ -0,0 +1,58 @@
+#include "common.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+// Пересчёт зависимых формул при изменении одной входной ячейки A1. Значение
+// A1 чередуется, поэтому каждый раз пересчитываются все зависимые формулы
+namespace {
+	void ChangeInput(benchmark::State& state, SheetInterface& sheet, int dependent) {
+		const std::string values[] = { "1", "2" };
+		std::size_t i = 0;
+		for (auto _ : state) {
+			sheet.SetCell({ 0, 0 }, values[i++ % 2]);
+		}
+		state.SetItemsProcessed(state.iterations() * dependent);
+	}
+
+	// A2 = A1+1, A3 = A2+1, ...
+	void BM_RecalcChain(benchmark::State& state) {
+		const int length = static_cast<int>(state.range(0));
+		auto sheet = CreateSheet();
+		sheet->SetCell({ 0, 0 }, "0");
+		for (int row = 1; row <= length; ++row) {
+			sheet->SetCell({ row, 0 }, "=A" + std::to_string(row) + "+1");
+		}
+		ChangeInput(state, *sheet, length);
+	}
+	BENCHMARK(BM_RecalcChain)->Arg(10)->Arg(100)->Arg(1000)->Arg(4000);
+
+	// B1..Bn зависят от A1, C1 = B1+...+Bn
+	void BM_RecalcDiamond(benchmark::State& state) {
+		const int width = static_cast<int>(state.range(0));
+		auto sheet = CreateSheet();
+		sheet->SetCell({ 0, 0 }, "0");
+		std::string sum = "=";
+		for (int row = 0; row < width; ++row) {
+			const std::string row_number = std::to_string(row + 1);
+			sheet->SetCell({ row, 1 }, "=A1*" + row_number);
+			sum += (row > 0 ? "+B" : "B") + row_number;
+		}
+		sheet->SetCell({ 0, 2 }, sum);
+		ChangeInput(state, *sheet, width + 1);
+	}
+	BENCHMARK(BM_RecalcDiamond)->Arg(4)->Arg(64)->Arg(512);
+
+	// B1..Bn зависят только от A1
+	void BM_RecalcFanOut(benchmark::State& state) {
+		const int count = static_cast<int>(state.range(0));
+		auto sheet = CreateSheet();
+		sheet->SetCell({ 0, 0 }, "0");
+		for (int row = 0; row < count; ++row) {
+			sheet->SetCell({ row, 1 }, "=A1+" + std::to_string(row));
+		}
+		ChangeInput(state, *sheet, count);
+	}
+	BENCHMARK(BM_RecalcFanOut)->Arg(10)->Arg(1000)->Arg(10000);
+} // namespace
@@ -0,0 +1,123 @@
+#include "common.h"
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+	constexpr int ROWS = 1000;
+	constexpr int COLS = 10;
+
+	// Ячейки блока ROWS x COLS по кругу: после первого прохода лист не растёт
+	Position CyclePosition(std::size_t i) {
+		return { static_cast<int>(i / COLS % ROWS), static_cast<int>(i % COLS) };
+	}
+
+	// Лист ROWS x COLS: числа в чётных столбцах, текст и формулы над числами в нечётных
+	std::unique_ptr<SheetInterface> MakeFilledSheet() {
+		auto sheet = CreateSheet();
+		for (int row = 0; row < ROWS; ++row) {
+			for (int col = 0; col < COLS; col += 2) {
+				sheet->SetCell({ row, col }, std::to_string(row * COLS + col));
+				const Position number{ row, col };
+				sheet->SetCell({ row, col + 1 }, row % 4 == 0
+					? "text " + std::to_string(row)
+					: "=" + number.ToString() + "*2+1");
+			}
+		}
+		return sheet;
+	}
+
+	void BM_SetCellText(benchmark::State& state) {
+		auto sheet = CreateSheet();
+		const std::vector<std::string> texts = { "text", "longer text that does not fit into SSO", "'=escaped", "" };
+		std::size_t i = 0;
+		for (auto _ : state) {
+			sheet->SetCell(CyclePosition(i), texts[i % texts.size()]);
+			++i;
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_SetCellText);
+
+	void BM_SetCellNumber(benchmark::State& state) {
+		auto sheet = CreateSheet();
+		std::vector<std::string> numbers;
+		for (int i = 0; i < 1000; ++i) {
+			numbers.push_back(std::to_string(i * 0.37));
+		}
+		std::size_t i = 0;
+		for (auto _ : state) {
+			sheet->SetCell(CyclePosition(i), numbers[i % numbers.size()]);
+			++i;
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_SetCellNumber);
+
+	// Формулы над ячейками вне блока, в который они записываются
+	void BM_SetCellFormula(benchmark::State& state) {
+		auto sheet = CreateSheet();
+		std::vector<std::string> formulas;
+		for (int row = 1; row <= 1000; ++row) {
+			const std::string r = std::to_string(row);
+			formulas.push_back("=(X" + r + "+Y" + r + ")*2-Z1/" + std::to_string(row % 7 + 1));
+		}
+		std::size_t i = 0;
+		for (auto _ : state) {
+			sheet->SetCell(CyclePosition(i), formulas[i % formulas.size()]);
+			++i;
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_SetCellFormula);
+
+	void BM_GetValue(benchmark::State& state) {
+		const auto sheet = MakeFilledSheet();
+		std::size_t i = 0;
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(sheet->GetCell(CyclePosition(i++))->GetValue());
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_GetValue);
+
+	// Очистка правой нижней ячейки ищет новую границу печатной области.
+	// В замер входит и запись ячейки обратно
+	void BM_ClearCellAtEdge(benchmark::State& state) {
+		auto sheet = MakeFilledSheet();
+		const Position edge{ ROWS - 1, COLS - 1 };
+		for (auto _ : state) {
+			sheet->ClearCell(edge);
+			sheet->SetCell(edge, "1");
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_ClearCellAtEdge);
+
+	void BM_PrintValues(benchmark::State& state) {
+		const auto sheet = MakeFilledSheet();
+		int64_t bytes = 0;
+		for (auto _ : state) {
+			std::ostringstream out;
+			sheet->PrintValues(out);
+			bytes += out.tellp();
+		}
+		state.SetBytesProcessed(bytes);
+	}
+	BENCHMARK(BM_PrintValues);
+
+	void BM_PrintTexts(benchmark::State& state) {
+		const auto sheet = MakeFilledSheet();
+		int64_t bytes = 0;
+		for (auto _ : state) {
+			std::ostringstream out;
+			sheet->PrintTexts(out);
+			bytes += out.tellp();
+		}
+		state.SetBytesProcessed(bytes);
+	}
+	BENCHMARK(BM_PrintTexts);
+} // namespace
@@ -0,0 +1,54 @@
+#include "common.h"
+#include "workload.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+// Загрузка листов из генератора нагрузок и случайные правки загруженного листа
+namespace {
+	void LoadSheet(benchmark::State& state, const std::vector<WorkloadOp>& ops) {
+		for (auto _ : state) {
+			auto sheet = CreateSheet();
+			benchmark::DoNotOptimize(ApplyWorkload(*sheet, ops));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ops.size()));
+	}
+
+	void BM_LoadRandomDag(benchmark::State& state) {
+		const int cells = static_cast<int>(state.range(0));
+		LoadSheet(state, WorkloadGenerator(1).RandomDag({ 1000, 100 }, cells, 0.5, 4));
+	}
+	BENCHMARK(BM_LoadRandomDag)->Arg(1000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+	void BM_LoadFilledColumns(benchmark::State& state) {
+		LoadSheet(state, WorkloadGenerator(1).FilledColumns(static_cast<int>(state.range(0)), 4));
+	}
+	BENCHMARK(BM_LoadFilledColumns)->Arg(1000)->Arg(Position::MAX_ROWS)->Unit(benchmark::kMillisecond);
+
+	// Одинаковое число ячеек: разбросанных по всему листу и заполняющих плотный блок
+	void BM_LoadSparseLayout(benchmark::State& state) {
+		LoadSheet(state, WorkloadGenerator(1).Layout({ Position::MAX_ROWS, Position::MAX_COLS }, 32'768.0 / (1 << 28)));
+	}
+	BENCHMARK(BM_LoadSparseLayout)->Unit(benchmark::kMillisecond);
+
+	void BM_LoadDenseLayout(benchmark::State& state) {
+		LoadSheet(state, WorkloadGenerator(1).Layout({ 256, 128 }, 1.0));
+	}
+	BENCHMARK(BM_LoadDenseLayout)->Unit(benchmark::kMillisecond);
+
+	// Правки по одной, включая отклонённые листом
+	void BM_Edits(benchmark::State& state) {
+		WorkloadGenerator generator(1);
+		const Size size{ 1000, 20 };
+		auto sheet = CreateSheet();
+		ApplyWorkload(*sheet, generator.RandomDag(size, 10'000, 0.5, 4));
+		const auto edits = generator.Edits(size, 10'000);
+		std::size_t i = 0;
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(ApplyWorkload(*sheet, { edits[i++ % edits.size()] }));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_Edits);
+} // namespace
@@ -0,0 +1,36 @@
+#include "benchmarks.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// Бенчмарк запускается, если его имя содержит filter
+#define RUN_BENCH(func, scale)                                          \
+    if (std::string_view(#func).find(filter) != std::string_view::npos) { \
+        std::cerr << "--- " << #func << std::endl;                      \
+        func(scale);                                                    \
+    }
+
+// spreadsheet_bench [множитель размеров задач] [часть имени бенчмарка]
+int main(int argc, char* argv[]) {
+    const double scale = argc > 1 ? std::stod(argv[1]) : 1.0;
+    const std::string_view filter = argc > 2 ? argv[2] : "";
+
+    RUN_BENCH(BenchFormulaParsing, scale);
+    RUN_BENCH(BenchParallelParsing, scale);
+    RUN_BENCH(BenchNumericCellsMemory, scale);
+    RUN_BENCH(BenchFormulaCellsMemory, scale);
+    RUN_BENCH(BenchCloneMemory, scale);
+    RUN_BENCH(BenchMemoryAccounting, scale);
+    RUN_BENCH(BenchNumberParsing, scale);
+    RUN_BENCH(BenchPositionConversion, scale);
+    RUN_BENCH(BenchConcurrentReads, scale);
+    RUN_BENCH(BenchScenarioEvaluation, scale);
+    RUN_BENCH(BenchColumnRuns, scale);
+    RUN_BENCH(BenchSmallDeltaRecalc, scale);
+    RUN_BENCH(BenchFormulaRecalc, scale);
+    RUN_BENCH(BenchConstantSubexpressions, scale);
+    RUN_BENCH(BenchSharedSubexpressions, scale);
+    RUN_BENCH(BenchReferencedCells, scale);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "common.h"
+#include "formula.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Значение формулы в 8 байтах вместо 16 у std::variant<double, FormulaError>
+// (NaN-boxing). Число хранится как есть, а ошибка и отсутствие значения - в
+// NaN с полезной нагрузкой, которые не возникают при вычислениях: любое NaN
+// при записи приводится к стандартному. Используется там, где значений много
+// (кэши значений формул, ячейки подграфов), а в CellInterface::Value и
+// FormulaInterface::Value превращается только на границе API
+class BoxedValue {
+public:
+    // Значения нет
+    BoxedValue()
+        : bits_(EMPTY) {
+    }
+
+    BoxedValue(double value) {
+        if (std::isnan(value)) {
+            value = std::numeric_limits<double>::quiet_NaN();
+        }
+        std::memcpy(&bits_, &value, sizeof(bits_));
+    }
+
+    BoxedValue(FormulaError error)
+        : bits_(ERROR | static_cast<std::uint32_t>(error.GetCategory())) {
+    }
+
+    BoxedValue(const FormulaInterface::Value& value)
+        : BoxedValue(std::holds_alternative<double>(value)
+            ? BoxedValue(std::get<double>(value))
+            : BoxedValue(std::get<FormulaError>(value))) {
+    }
+
+    bool IsEmpty() const {
+        return bits_ == EMPTY;
+    }
+
+    bool IsError() const {
+        return (bits_ & TAG_MASK) == ERROR;
+    }
+
+    bool IsNumber() const {
+        return !IsEmpty() && !IsError();
+    }
+
+    double GetNumber() const {
+        double value = 0.0;
+        std::memcpy(&value, &bits_, sizeof(value));
+        return value;
+    }
+
+    FormulaError GetError() const {
+        return static_cast<FormulaError::Category>(bits_ & PAYLOAD_MASK);
+    }
+
+    // Для непустого значения
+    FormulaInterface::Value ToValue() const {
+        if (IsError()) {
+            return GetError();
+        }
+        return GetNumber();
+    }
+
+    CellInterface::ValueView ToValueView() const {
+        if (IsError()) {
+            return GetError();
+        }
+        return GetNumber();
+    }
+
+private:
+    // Отрицательные quiet NaN с ненулевыми битами 48-50. Процессор сам такие не
+    // порождает: его NaN по умолчанию 0xFFF8'0000'0000'0000
+    static constexpr std::uint64_t TAG_MASK = 0xFFFF'0000'0000'0000;
+    static constexpr std::uint64_t PAYLOAD_MASK = 0x0000'0000'FFFF'FFFF;
+    static constexpr std::uint64_t ERROR = 0xFFF9'0000'0000'0000;
+    static constexpr std::uint64_t EMPTY = 0xFFFA'0000'0000'0000;
+
+    std::uint64_t bits_;
+};
+
+static_assert(sizeof(BoxedValue) == 8);
@@ -1,262 +1,237 @@
 #include "cell.h"
 
+#include "memory_usage.h"
+
 #include <cassert>
+#include <cctype>
+#include <charconv>
 #include <iostream>
 #include <string>
 #include <optional>
+#include <utility>
 
 namespace CellImpl {
 
-	Impl::Impl(std::string_view str)
-		: text_(str) {
-	}
-
-	const std::string& Impl::GetText() const {
-		return text_;
-	}
-
-	std::vector<Position> Impl::GetReferencedCells() const {
-		return {};
-	}
-	// --------------------------------------------------------------------
+	namespace {
+		// Каноничная (кратчайшая) запись числа, по ней восстанавливается текст
+		// числовой ячейки
+		std::string FormatNumber(double value) {
+			char buffer[32];
+			auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+			assert(ec == std::errc());
+			return std::string(buffer, end);
+		}
+	} // namespace
 
-	EmptyImpl::EmptyImpl()
-		: Impl("") {
-	}
+	std::optional<double> ParseNumber(std::string_view str) {
+		const char* first = str.data();
+		const char* last = first + str.size();
+		// Знак минус from_chars разбирает сам, а плюс не принимает
+		const char* digits = first;
+		if (digits != last && (*digits == '+' || *digits == '-')) {
+			++digits;
+			if (*first == '+') {
+				first = digits;
+			}
+		}
+		// После знака обязательно идёт цифра или точка, так отсекаются inf и nan
+		if (digits == last || !(std::isdigit(static_cast<unsigned char>(*digits)) || *digits == '.')) {
+			return std::nullopt;
+		}
 
-	CellInterface::Value EmptyImpl::GetValue() const {
-		return "";
+		double value = 0.0;
+		auto [end, ec] = std::from_chars(first, last, value);
+		if (ec != std::errc() || end != last) {
+			return std::nullopt;
+		}
+		return value;
 	}
 
-	// --------------------------------------------------------------------
+	Content CreateTextContent(std::string_view text, StringPool& pool) {
+		if (text.empty()) {
+			return std::monostate();
+		}
 
-	TextImpl::TextImpl(std::string_view str)
-		: Impl(str) {
-		if (str.size() > 0 && str[0] == ESCAPE_SIGN) {
+		std::string_view str = text;
+		if (str[0] == ESCAPE_SIGN) {
 			str.remove_prefix(1);
 		}
 		// Определяем что строка может быть числом
-		if (!str.empty() && str.find_first_not_of("0123456789.") == std::string_view::npos) {
-			value_ = std::stod(std::string(str));
-			is_number_ = true;
-		}
-		else {
-			value_ = std::string(str);
+		if (auto value = ParseNumber(str)) {
+			if (FormatNumber(*value) == text) {
+				return *value;
+			}
+			return NumberTextImpl{ *value, pool.Add(text) };
 		}
+		return TextImpl{ pool.Add(text) };
 	}
 
-	CellInterface::Value TextImpl::GetValue() const {
-		if (is_number_) {
-			return std::get<double>(value_);
-		}
-		else {
-			return std::get<std::string>(value_);
-		}
+	// --------------------------------------------------------------------
+
+	FormulaImpl::FormulaImpl(std::unique_ptr<FormulaInterface> formula)
+		: formula_(std::move(formula))
+		// Формула неизменяема, поэтому её текст строится один раз
+		, text_(FORMULA_SIGN + formula_->GetExpression()) {
 	}
 
-	// --------------------------------------------------------------------
-	template <class T>
-	inline void hash_combine(std::size_t& s, const T& v) {
-		std::hash<T> h;
-		s ^= h(v) + 0x9e3779b9 + (s << 6) + (s >> 2);
+	void FormulaImpl::Evaluate(const SheetInterface& sheet) {
+		value_ = formula_->Evaluate(sheet);
 	}
 
-	struct PositionHash {	
-		std::size_t operator()(Position const& pos) const
-		{
-			std::size_t res = 0;
-			hash_combine(res, pos.col);
-			hash_combine(res, pos.row);
-			return res;
-		}
-	};
-	
-	void FormulaImpl::CheckCircular(const std::vector<Position>& positions, SheetInterface& sheet) const {
-		std::unordered_set<Position, PositionHash> checked_positions;
-				
-		for (const auto& pos : positions) {
-			// Такую позицию ещё не проверяли
-			if (checked_positions.count(pos) == 0) {
-				auto temp_cell = sheet.GetCell(pos);
-				// Ячейка за границами таблицы
-				if (temp_cell == nullptr) {
-					continue;
-				}
-
-				if (pos == self_) {
-					throw CircularDependencyException("");
-				}
-				checked_positions.insert(pos);				
-				CheckCircular(temp_cell->GetReferencedCells(), sheet);
-			}			
-		}
+	void FormulaImpl::Evaluate(const SheetInterface& sheet, SubexpressionPool& subexpressions) {
+		value_ = subexpressions.Evaluate(shared_root_.value(), sheet);
 	}
 
-	FormulaImpl::FormulaImpl(std::string_view str, SheetInterface& sheet, Position self)
-		: Impl(str), self_(self) {
-		try {
-			formula_ = ParseFormula(std::string(str.begin() + 1, str.end()));
-			// Введена синтаксически неверная формула, значение не меняем			
-		}
-		catch (.../*FormulaException& e*/) {			
-			throw FormulaException("");
-		}
+	void FormulaImpl::EvaluateBound() {
+		value_ = formula_->Evaluate(bound_cells_);
+	}
 
-		bool valid_references = true;
-		// Проверям что все ячейки на которые ссылается формула могут
-		// быть представлены как числа, существуют а их позиции верны
-		const auto referenced_cell = GetReferencedCells();
-		for (const Position& pos : referenced_cell) {
-			auto temp_cell = static_cast<Cell*>(sheet.GetCell(pos));
-
-			if (!temp_cell) {
-				sheet.SetCell(pos, "");
-				continue;
-			}			
-			if (!std::holds_alternative<double>(temp_cell->GetValue())) {				
-				value_ = FormulaError(FormulaError::Category::Value);
-				valid_references = false;
-			}		
-			temp_cell->GetReferringCells().push_back(self);
-		}
+	std::uint64_t FormulaImpl::GetLayoutVersion() const {
+		return layout_version_;
+	}
+
+	void FormulaImpl::Invalidate() {
+		value_ = BoxedValue();
+	}
 
-		// Проверям что нет цикличной зависимости
-		CheckCircular(GetReferencedCells(), sheet);
+	bool FormulaImpl::IsValid() const {
+		return !value_.IsEmpty();
+	}
 
-		if (valid_references) {
-			Evaluate(sheet);
-		}
+	const std::string& FormulaImpl::GetText() const {
+		return text_;
 	}
 
-	CellInterface::Value FormulaImpl::GetValue() const {
-		if (std::holds_alternative<FormulaError>(value_.value())) {
-			return std::get<FormulaError>(value_.value());
-		}
-		return std::get<double>(value_.value());		
+	CellInterface::ValueView FormulaImpl::GetValueView() const {
+		assert(IsValid());
+		return value_.ToValueView();
 	}
 
-	std::vector<Position> FormulaImpl::GetReferencedCells() const {
-		if (!formula_) {
-			return {};
-		}
+	const std::vector<Position>& FormulaImpl::GetReferencedCells() const {
 		return formula_->GetReferencedCells();
 	}
 
-	void FormulaImpl::Evaluate(SheetInterface& sheet) {		
-		text_ = FORMULA_SIGN + formula_->GetExpression();
-		auto result = formula_->Evaluate(sheet);
-		// Формула успешно посчиталась
-		if (std::holds_alternative<double>(result)) {
-			value_ = std::get<double>(result);
-		}
-		// Ошибка при вычислении
-		else {
-			value_ = std::get<FormulaError>(result);
-		}
+	FormulaProgram FormulaImpl::GetProgram() const {
+		return formula_->GetProgram();
 	}
 
-	void FormulaImpl::Invalidate() {
-		value_ = std::nullopt;
+	std::size_t FormulaImpl::GetMemoryUsage() const {
+		// Привязка всегда по одному указателю на ячейку формулы, так результат
+		// не зависит от того, привязана ли формула сейчас
+		return sizeof(*this) - sizeof(value_) + Memory::HeapSize(text_)
+			+ GetReferencedCells().size() * sizeof(const CellInterface*)
+			+ Memory::SHARED_CONTROL_SIZE + formula_->GetMemoryUsage();
 	}
 
-	bool FormulaImpl::IsValid() const {
-		return value_.has_value();
+	std::optional<SubexpressionPool::NodeId> FormulaImpl::GetSharedRoot() const {
+		return shared_root_;
 	}
-} // namespace CellImpl
 
-// ----------------------------- Cell ------------------------------------------
+	void FormulaImpl::SetSharedRoot(SubexpressionPool::NodeId root) {
+		shared_root_ = root;
+	}
 
-Cell::Cell(std::string_view text, SheetInterface& sheet, Position self)
-	: sheet_(sheet), self_(self) {
-	CreateImpl(text);
-}
+	const std::vector<Position>& GetReferencedCells(const Content& content) {
+		static const std::vector<Position> no_cells;
+		auto formula = std::get_if<std::unique_ptr<FormulaImpl>>(&content);
+		return formula ? (*formula)->GetReferencedCells() : no_cells;
+	}
 
-void Cell::Set(std::string text) {
-	CreateImpl(text);
-	// Пересчитываем эту ячейку и другие, которые используют данные этой ячейки
-	// Чтобы пересчитывать только 1 раз каждую ячейку, инвалидируем вначале все ячейки
-	// а вовремя пересчета будет делать их валидными и проверять чтобы не пересчитывать валидные ячейки
-	ReEvaluate();
-}
+} // namespace CellImpl
 
-Cell::~Cell() {}
+// ----------------------------- Cell ------------------------------------------
 
-void Cell::ReEvaluateReferringCells() {
-	for (const auto& pos : referring_cells_) {
-		auto temp_cell = static_cast<Cell*>(sheet_.GetCell(pos));
-		if (!temp_cell->IsValid()) {
-			temp_cell->ReEvaluate();
+namespace {
+	struct CellTextGetter {
+		std::string operator()(std::monostate) const {
+			return {};
 		}
-	}
-}
-
-void Cell::ReEvaluate() {
-	// Если это формульная ячейка, пересчитываем её, а затем
-	// пересчитываем все ячейки, которые зависят от текущей
-	if (IsFormulaImpl()) {
-		static_cast<CellImpl::FormulaImpl*>(impl_.get())->Evaluate(sheet_);		
-	}
-	InvalidateReferringCells();
-	ReEvaluateReferringCells();	
-}
+		std::string operator()(double value) const {
+			return CellImpl::FormatNumber(value);
+		}
+		std::string operator()(const CellImpl::TextImpl& impl) const {
+			return std::string(impl.text.Get());
+		}
+		std::string operator()(const CellImpl::NumberTextImpl& impl) const {
+			return std::string(impl.text.Get());
+		}
+		std::string operator()(const std::unique_ptr<CellImpl::FormulaImpl>& impl) const {
+			return impl->GetText();
+		}
+	};
 
-bool Cell::IsFormulaImpl() {
-	return dynamic_cast<CellImpl::FormulaImpl*>(impl_.get());
-}
+	struct CellValueGetter {
+		CellInterface::ValueView operator()(std::monostate) const {
+			return std::string_view();
+		}
+		CellInterface::ValueView operator()(double value) const {
+			return value;
+		}
+		CellInterface::ValueView operator()(const CellImpl::TextImpl& impl) const {
+			// Экранирующий символ в значение не попадает
+			std::string_view text = impl.text.Get();
+			if (!text.empty() && text[0] == ESCAPE_SIGN) {
+				text.remove_prefix(1);
+			}
+			return text;
+		}
+		CellInterface::ValueView operator()(const CellImpl::NumberTextImpl& impl) const {
+			return impl.value;
+		}
+		CellInterface::ValueView operator()(const std::unique_ptr<CellImpl::FormulaImpl>& impl) const {
+			return impl->GetValueView();
+		}
+	};
+} // namespace
 
-void Cell::Invalidate() {
-	if (IsFormulaImpl()) {
-		static_cast<CellImpl::FormulaImpl*>(impl_.get())->Invalidate();
-	}	
+Cell::Cell(const Cell& other)
+	: content_(std::visit([](const auto& content) -> CellImpl::Content {
+		if constexpr (std::is_same_v<std::decay_t<decltype(content)>, std::unique_ptr<CellImpl::FormulaImpl>>) {
+			return std::make_unique<CellImpl::FormulaImpl>(*content);
+		}
+		else {
+			return content;
+		}
+	}, other.content_)) {
 }
 
-void Cell::InvalidateReferringCells() {
-	for (const auto& pos : referring_cells_) {		
-		static_cast<Cell*>(sheet_.GetCell(pos))->Invalidate();
-	}
+CellImpl::Content Cell::SetContent(CellImpl::Content content) {
+	return std::exchange(content_, std::move(content));
 }
 
-void Cell::CreateImpl(std::string_view text) {
-	// Пустая ячейка
-	if (text.empty()) {
-		impl_ = std::make_unique<CellImpl::EmptyImpl>();
-	}
-	// Формула
-	if (text.size() > 1 && text[0] == FORMULA_SIGN) {
-		impl_ = std::make_unique<CellImpl::FormulaImpl>(text, sheet_, self_);
-	}
-	// Текстовая
-	else {
-		impl_ = std::make_unique<CellImpl::TextImpl>(text);
-	}
+const CellImpl::Content& Cell::GetContent() const {
+	return content_;
 }
 
-bool Cell::IsValid() {
-	// Если это формульная ячейка и она валидна, текстовая ячейка не может быть невалидной
-	if (IsFormulaImpl()) {
-		return static_cast<CellImpl::FormulaImpl*>(impl_.get())->IsValid();
-	}
-	else {
-		return true;
-	}
+CellImpl::FormulaImpl* Cell::GetFormula() {
+	auto formula = std::get_if<std::unique_ptr<CellImpl::FormulaImpl>>(&content_);
+	return formula ? formula->get() : nullptr;
 }
 
-std::vector<Position>& Cell::GetReferringCells() {
-	return referring_cells_;
+const CellImpl::FormulaImpl* Cell::GetFormula() const {
+	auto formula = std::get_if<std::unique_ptr<CellImpl::FormulaImpl>>(&content_);
+	return formula ? formula->get() : nullptr;
 }
 
-void Cell::Clear() {
-	CreateImpl("");
+CellInterface::Value Cell::GetValue() const {
+	return std::visit([](const auto& value) -> CellInterface::Value {
+		if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string_view>) {
+			return std::string(value);
+		}
+		else {
+			return value;
+		}
+	}, GetValueView());
 }
 
-CellInterface::Value Cell::GetValue() const {
-	return impl_->GetValue();
+CellInterface::ValueView Cell::GetValueView() const {
+	return std::visit(CellValueGetter(), content_);
 }
 
 std::string Cell::GetText() const {
-	return impl_->GetText();
+	return std::visit(CellTextGetter(), content_);
 }
 
 std::vector<Position> Cell::GetReferencedCells() const {
-	return impl_->GetReferencedCells();		
-}
\ No newline at end of file
+	return CellImpl::GetReferencedCells(content_);
+}
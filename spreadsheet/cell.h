@@ -1,96 +1,138 @@
 ﻿#pragma once
 
+#include "boxed_value.h"
 #include "common.h"
 #include "formula.h"
+#include "string_pool.h"
+#include "subexpressions.h"
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 
 namespace CellImpl {
 
-    class Impl {
-    public:
-        Impl(std::string_view str);
-
-        const std::string& GetText() const;
-        virtual CellInterface::Value GetValue() const = 0;        
-        virtual std::vector<Position> GetReferencedCells() const;        
-    protected:
-        std::string text_;
+    template <class T>
+    inline void hash_combine(std::size_t& s, const T& v) {
+        std::hash<T> h;
+        s ^= h(v) + 0x9e3779b9 + (s << 6) + (s >> 2);
+    }
+
+    struct PositionHash {
+        std::size_t operator()(Position const& pos) const {
+            std::size_t res = 0;
+            hash_combine(res, pos.col);
+            hash_combine(res, pos.row);
+            return res;
+        }
     };
 
-    // Пустая ячейка
-    class EmptyImpl : public Impl {
-    public:
-        EmptyImpl();
-        CellInterface::Value GetValue() const override;
+    // Текстовая ячейка. Текст хранится в пуле строк листа
+    struct TextImpl {
+        StringPool::Handle text;
     };
 
-    // Текстовая ¤чейка
-    class TextImpl : public Impl {
-    public:
-        TextImpl(std::string_view str);
-        CellInterface::Value GetValue() const override;
-    private:
-        std::variant<std::string, double> value_;
-        // Возможно ли представить текст ячейки в качестве числа
-        bool is_number_ = false;
+    // Ячейка с числом, текст которого не совпадает с каноничной записью числа
+    // (например "1.50" или "'12"), поэтому текст приходится хранить отдельно
+    struct NumberTextImpl {
+        double value = 0.0;
+        StringPool::Handle text;
     };
 
-    // Ячейка с формулой
-    class FormulaImpl : public Impl {
+    // Ячейка с формулой. Сама формула неизменяема и при копировании ячейки
+    // разделяется между копиями, копируются только текст и вычисленное значение
+    class FormulaImpl {
     public:
-        FormulaImpl(std::string_view str, SheetInterface& sheet, Position self);
-        void Evaluate(SheetInterface& sheet);
+        explicit FormulaImpl(std::unique_ptr<FormulaInterface> formula);
+
+        void Evaluate(const SheetInterface& sheet);
+        // Вычисляет формулу через пул общих подвыражений, в котором она зарегистрирована
+        void Evaluate(const SheetInterface& sheet, SubexpressionPool& subexpressions);
+        // Вычисляет формулу по ячейкам, к которым она привязана через Bind
+        void EvaluateBound();
+        // Привязывает формулу к ячейкам хранилища: find(pos) возвращает ячейку или
+        // nullptr. Привязка верна, пока не изменится версия расположения ячеек
+        template <typename Find>
+        void Bind(std::uint64_t layout_version, Find find);
+        // Версия расположения ячеек, при которой сделана привязка, 0 - формула не привязана
+        std::uint64_t GetLayoutVersion() const;
         void Invalidate();
-
         bool IsValid() const;
 
-        CellInterface::Value GetValue() const override;
-        std::vector<Position> GetReferencedCells() const;
-    private:
-        std::unique_ptr<FormulaInterface> formula_;
-        Position self_;
-        // Если значение есть значит ячейка валидна, при инвалидации¤ значение очищаетс¤
-        std::optional<std::variant<double, FormulaError>> value_; 
+        const std::string& GetText() const;
+        CellInterface::ValueView GetValueView() const;
+        const std::vector<Position>& GetReferencedCells() const;
+        FormulaProgram GetProgram() const;
+        // Память формулы без вычисленного значения. Не меняется, пока формула в ячейке
+        std::size_t GetMemoryUsage() const;
 
-        void CheckCircular(const std::vector<Position>& positions, SheetInterface& sheet) const;
+        // Корень формулы в пуле общих подвыражений листа, если пул включён
+        std::optional<SubexpressionPool::NodeId> GetSharedRoot() const;
+        void SetSharedRoot(SubexpressionPool::NodeId root);
+
+    private:
+        std::shared_ptr<const FormulaInterface> formula_;
+        std::string text_;
+        std::optional<SubexpressionPool::NodeId> shared_root_;
+        // Ячейки формулы в порядке GetReferencedCells()
+        std::vector<const CellInterface*> bound_cells_;
+        std::uint64_t layout_version_ = 0;
+        // Если значение есть значит ячейка валидна, при инвалидации значение очищается
+        BoxedValue value_;
     };
 
+    // Содержимое ячейки: пустая ячейка, число (хранится прямо в ячейке, а текст
+    // восстанавливается по значению), текст, число с нестандартной записью или
+    // дескриптор формулы
+    using Content = std::variant<std::monostate, double, TextImpl, NumberTextImpl,
+        std::unique_ptr<FormulaImpl>>;
+
+    // Распознаёт число в тексте ячейки за один проход без выделения памяти.
+    // Число - это вся строка целиком в виде [+|-]цифры[.[цифры]] или [+|-].цифры,
+    // за которыми может идти экспонента e|E[+|-]цифры. Пробелы, inf, nan, шестнадцатеричная
+    // запись и числа вне диапазона double числами не считаются
+    std::optional<double> ParseNumber(std::string_view str);
+
+    // Создаёт содержимое неформульной ячейки по её тексту
+    Content CreateTextContent(std::string_view text, StringPool& pool);
+
+    // Ячейки, которые использует формула. Для неформульного содержимого список пуст
+    const std::vector<Position>& GetReferencedCells(const Content& content);
+
+    template <typename Find>
+    void FormulaImpl::Bind(std::uint64_t layout_version, Find find) {
+        const auto& cells = GetReferencedCells();
+        bound_cells_.resize(cells.size());
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            bound_cells_[i] = find(cells[i]);
+        }
+        layout_version_ = layout_version;
+    }
+
 } // namespace CellImpl
 
+// Ячейка не хранит ссылок на лист и свою позицию: пересчётом и графом зависимостей
+// занимается Sheet
 class Cell : public CellInterface {
 public:
-    Cell(std::string_view text, SheetInterface& sheet, Position self);
-    ~Cell();
+    Cell() = default;
+    Cell(const Cell& other);
+    Cell& operator=(const Cell&) = delete;
 
-    void Set(std::string text);
-    void Clear();
+    // Возвращает прежнее содержимое
+    CellImpl::Content SetContent(CellImpl::Content content);
+    const CellImpl::Content& GetContent() const;
 
     CellInterface::Value GetValue() const override;
+    CellInterface::ValueView GetValueView() const override;
     std::string GetText() const override;
 
-    std::vector<Position> GetReferencedCells() const override;  
+    std::vector<Position> GetReferencedCells() const override;
+
+    // Возвращает формулу ячейки или nullptr, если ячейка не формульная
+    CellImpl::FormulaImpl* GetFormula();
+    const CellImpl::FormulaImpl* GetFormula() const;
 
-    std::vector<Position>& GetReferringCells();
-    // Пересчитывает значение ячейки
-    void ReEvaluate();
-        
 private:
-    SheetInterface& sheet_;
-    Position self_; // Позиция ячейки в таблице
-    std::unique_ptr<CellImpl::Impl> impl_;
-
-    // Вектор ячеек в которых используется данная ячейка
-    std::vector<Position> referring_cells_;
-
-    // Пересчёт ячеек, в которых используется данная ячейка
-    void ReEvaluateReferringCells();
-    // Создаёт экземпляр Impl  в зависимости от text
-    void CreateImpl(std::string_view text);
-    // Инвалидирует все ячейки которые используют данную
-    void InvalidateReferringCells();
-    void Invalidate();
-
-    bool IsFormulaImpl();
-    bool IsValid();
+    CellImpl::Content content_;
 };
@@ -0,0 +1,183 @@
+#include "cell_storage.h"
+
+#include "memory_usage.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+	std::atomic<std::uint64_t> last_layout_version{ 0 };
+} // namespace
+
+CellStorage::CellStorage()
+	: tiles_(std::make_shared<Tiles>())
+	, layout_version_(++last_layout_version) {
+}
+
+const Cell* CellStorage::Find(Position pos) const {
+	if (const Tile* tile = FindTile(Tiling::GetTileId(pos))) {
+		auto cell = tile->cells.find(Tiling::GetOffset(pos));
+		if (cell != tile->cells.end()) {
+			return &cell->second;
+		}
+	}
+	return nullptr;
+}
+
+Cell* CellStorage::FindForWrite(Position pos) {
+	// Тайл без нужной ячейки копировать незачем
+	if (!Find(pos)) {
+		return nullptr;
+	}
+	return &GetTileForWrite(Tiling::GetTileId(pos)).cells.at(Tiling::GetOffset(pos));
+}
+
+Cell& CellStorage::Create(Position pos) {
+	Tile& tile = GetTileForWrite(Tiling::GetTileId(pos));
+	auto [cell, inserted] = tile.cells.try_emplace(Tiling::GetOffset(pos));
+	if (inserted) {
+		++cell_count_;
+		++tile.cells_in_row[pos.row % Tiling::TILE_SIZE];
+		++tile.cells_in_col[pos.col % Tiling::TILE_SIZE];
+		// Формулы, привязанные к отсутствующей ячейке, должны увидеть новую
+		ChangeLayout();
+	}
+	return cell->second;
+}
+
+void CellStorage::Erase(Position pos) {
+	if (!Find(pos)) {
+		return;
+	}
+	const int tile_id = Tiling::GetTileId(pos);
+	Tile& tile = GetTileForWrite(tile_id);
+	tile.cells.erase(Tiling::GetOffset(pos));
+	--cell_count_;
+	ChangeLayout();
+	--tile.cells_in_row[pos.row % Tiling::TILE_SIZE];
+	--tile.cells_in_col[pos.col % Tiling::TILE_SIZE];
+
+	if (tile.cells.empty() && tile.referring.empty()) {
+		GetTilesForWrite().erase(tile_id);
+	}
+}
+
+const std::vector<Position>* CellStorage::GetReferring(Position pos) const {
+	if (const Tile* tile = FindTile(Tiling::GetTileId(pos))) {
+		auto referring = tile->referring.find(Tiling::GetOffset(pos));
+		if (referring != tile->referring.end()) {
+			return &referring->second;
+		}
+	}
+	return nullptr;
+}
+
+void CellStorage::AddReferring(Position pos, Position referring) {
+	auto& positions = GetTileForWrite(Tiling::GetTileId(pos)).referring[Tiling::GetOffset(pos)];
+	auto it = std::lower_bound(positions.begin(), positions.end(), referring);
+	if (it == positions.end() || !(*it == referring)) {
+		positions.insert(it, referring);
+		++referring_count_;
+		// Пустые списки не хранятся, значит список только что создан
+		if (positions.size() == 1) {
+			++referring_lists_;
+		}
+	}
+}
+
+void CellStorage::RemoveReferring(Position pos, Position referring) {
+	const auto current = GetReferring(pos);
+	if (!current || !std::binary_search(current->begin(), current->end(), referring)) {
+		return;
+	}
+
+	const int tile_id = Tiling::GetTileId(pos);
+	Tile& tile = GetTileForWrite(tile_id);
+	auto positions = tile.referring.find(Tiling::GetOffset(pos));
+	auto& vec = positions->second;
+	vec.erase(std::lower_bound(vec.begin(), vec.end(), referring));
+	--referring_count_;
+
+	if (vec.empty()) {
+		--referring_lists_;
+		tile.referring.erase(positions);
+		if (tile.cells.empty() && tile.referring.empty()) {
+			GetTilesForWrite().erase(tile_id);
+		}
+	}
+	// Сжимаем список, если после удалений он занимает намного больше памяти, чем нужно
+	else if (vec.capacity() > 4 * vec.size()) {
+		vec.shrink_to_fit();
+	}
+}
+
+const CellStorage::Tile* CellStorage::FindTile(int tile_id) const {
+	auto tile = tiles_->find(tile_id);
+	return tile != tiles_->end() ? tile->second.get() : nullptr;
+}
+
+std::vector<int> CellStorage::GetTileIds() const {
+	std::vector<int> tile_ids;
+	tile_ids.reserve(tiles_->size());
+	for (const auto& [tile_id, tile] : *tiles_) {
+		tile_ids.push_back(tile_id);
+	}
+	return tile_ids;
+}
+
+Size CellStorage::GetLastPosition() const {
+	Size last{ -1, -1 };
+	for (const auto& [tile_id, tile] : *tiles_) {
+		const Position origin = Tiling::GetTileOrigin(tile_id);
+		for (int i = Tiling::TILE_SIZE - 1; i >= 0 && origin.row + i > last.rows; --i) {
+			if (tile->cells_in_row[i] > 0) {
+				last.rows = origin.row + i;
+				break;
+			}
+		}
+		for (int i = Tiling::TILE_SIZE - 1; i >= 0 && origin.col + i > last.cols; --i) {
+			if (tile->cells_in_col[i] > 0) {
+				last.cols = origin.col + i;
+				break;
+			}
+		}
+	}
+	return last;
+}
+
+CellStorage::Tiles& CellStorage::GetTilesForWrite() {
+	if (tiles_.use_count() > 1) {
+		tiles_ = std::make_shared<Tiles>(*tiles_);
+	}
+	return *tiles_;
+}
+
+CellStorage::Tile& CellStorage::GetTileForWrite(int tile_id) {
+	auto& tile = GetTilesForWrite()[tile_id];
+	if (!tile) {
+		tile = std::make_shared<Tile>();
+	}
+	else if (tile.use_count() > 1) {
+		tile = std::make_shared<Tile>(*tile);
+		ChangeLayout();
+	}
+	return *tile;
+}
+
+std::uint64_t CellStorage::GetLayoutVersion() const {
+	return layout_version_;
+}
+
+std::size_t CellStorage::GetCellsMemory() const {
+	return tiles_->size() * (Memory::SHARED_SIZE<Tile> + Memory::HASH_NODE_SIZE<Tiles::value_type>)
+		+ cell_count_ * Memory::HASH_NODE_SIZE<std::pair<const int, Cell>>;
+}
+
+std::size_t CellStorage::GetReferringMemory() const {
+	return referring_lists_ * Memory::HASH_NODE_SIZE<std::pair<const int, std::vector<Position>>>
+		+ referring_count_ * sizeof(Position);
+}
+
+void CellStorage::ChangeLayout() {
+	layout_version_ = ++last_layout_version;
+}
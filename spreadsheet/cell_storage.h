@@ -0,0 +1,82 @@
+#pragma once
+
+#include "cell.h"
+#include "common.h"
+#include "tiling.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Ячейки листа и граф зависимостей между ними, разбитые на тайлы. Копирование
+// хранилища занимает O(1): копии разделяют тайлы до первого изменения, после
+// чего изменяемый тайл копируется. Так копия листа занимает память только под
+// изменённые тайлы. Разделяемые тайлы не синхронизируются, поэтому с копиями
+// одного хранилища работают из одного потока
+class CellStorage {
+public:
+    struct Tile {
+        // Ячейки по смещению внутри тайла
+        std::unordered_map<int, Cell> cells;
+        // Для каждой ячейки тайла позиции ячеек, в которых она используется,
+        // по возрастанию и без повторов. Связи хранятся и для уже удалённых
+        // ячеек, пока на них ссылаются формулы
+        std::unordered_map<int, std::vector<Position>> referring;
+        // Сколько ячеек в каждой строке и каждом столбце тайла, по ним находятся границы листа
+        std::array<std::uint16_t, Tiling::TILE_SIZE> cells_in_row{};
+        std::array<std::uint16_t, Tiling::TILE_SIZE> cells_in_col{};
+    };
+
+    CellStorage();
+
+    const Cell* Find(Position pos) const;
+    // Ячейка для изменения или nullptr, если её нет. Тайл, разделяемый с другими
+    // копиями, предварительно копируется, поэтому указатели на его ячейки,
+    // полученные ранее, становятся указателями на ячейки копии
+    Cell* FindForWrite(Position pos);
+    // Возвращает ячейку для изменения, при необходимости создав пустую
+    Cell& Create(Position pos);
+    void Erase(Position pos);
+
+    // Ячейки, которые используют данную, или nullptr, если таких нет
+    const std::vector<Position>* GetReferring(Position pos) const;
+    void AddReferring(Position pos, Position referring);
+    void RemoveReferring(Position pos, Position referring);
+
+    // Тайл или nullptr, если в нём нет ни ячеек, ни связей
+    const Tile* FindTile(int tile_id) const;
+    std::vector<int> GetTileIds() const;
+    // Индексы последних непустых строки и столбца, -1, -1 для пустого хранилища
+    Size GetLastPosition() const;
+
+    // Меняется, когда указатели на ячейки, полученные ранее, могли стать неверными:
+    // при создании и удалении ячейки и при копировании тайла. Пока версия та же,
+    // Find для любой позиции вернёт тот же указатель. Версии не повторяются
+    // между разными хранилищами и никогда не равны 0
+    std::uint64_t GetLayoutVersion() const;
+
+    // Память ячеек и тайлов, в которых они хранятся. Разделяемые с копиями
+    // тайлы учитываются в каждой копии. Считается за O(1)
+    std::size_t GetCellsMemory() const;
+    // Память связей графа зависимостей, за O(1)
+    std::size_t GetReferringMemory() const;
+
+private:
+    using Tiles = std::unordered_map<int, std::shared_ptr<Tile>>;
+
+    // Копии хранилища разделяют и сам список тайлов
+    std::shared_ptr<Tiles> tiles_;
+    std::uint64_t layout_version_;
+    // Сколько ячеек во всех тайлах, сколько непустых списков использующих
+    // ячеек и сколько позиций в этих списках
+    std::size_t cell_count_ = 0;
+    std::size_t referring_lists_ = 0;
+    std::size_t referring_count_ = 0;
+
+    Tiles& GetTilesForWrite();
+    // Возвращает тайл для изменения, при необходимости создав или скопировав его
+    Tile& GetTileForWrite(int tile_id);
+    void ChangeLayout();
+};
@@ -0,0 +1,74 @@
+#include "column_runs.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+	std::uint64_t ToBits(double value) {
+		std::uint64_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+} // namespace
+
+ColumnRun::ColumnRun(Position pos, FormulaProgram program)
+	: first_(pos)
+	, program_(std::move(program))
+	, relative_(program_.ops.size()) {
+}
+
+bool ColumnRun::TryAppend(Position pos, const FormulaProgram& program) {
+	using Code = FormulaProgram::Op::Code;
+
+	if (pos.col != first_.col || pos.row != first_.row + size_ || program.ops.size() != program_.ops.size()) {
+		return false;
+	}
+	auto relative = relative_;
+	for (std::size_t i = 0; i < program.ops.size(); ++i) {
+		const auto& op = program.ops[i];
+		const auto& first_op = program_.ops[i];
+		if (op.code != first_op.code) {
+			return false;
+		}
+		// Числа сравниваются побитово, чтобы 0 и -0 не попали в одну серию
+		if (op.code == Code::Number && ToBits(op.number) != ToBits(first_op.number)) {
+			return false;
+		}
+		if (op.code != Code::Cell) {
+			continue;
+		}
+
+		const Position shifted{ first_op.cell.row + size_, first_op.cell.col };
+		std::optional<bool> is_relative;
+		if (op.cell == shifted) {
+			is_relative = true;
+		}
+		else if (op.cell == first_op.cell) {
+			is_relative = false;
+		}
+		if (!is_relative || (relative[i] && *relative[i] != *is_relative)) {
+			return false;
+		}
+		relative[i] = is_relative;
+	}
+
+	relative_ = std::move(relative);
+	++size_;
+	return true;
+}
+
+Position ColumnRun::GetFirst() const {
+	return first_;
+}
+
+int ColumnRun::GetSize() const {
+	return size_;
+}
+
+const FormulaProgram& ColumnRun::GetProgram() const {
+	return program_;
+}
+
+bool ColumnRun::IsRelative(std::size_t op) const {
+	return relative_[op].value_or(false);
+}
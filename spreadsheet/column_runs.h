@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common.h"
+#include "formula.h"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Серия формул одинаковой формы в подряд идущих строках одного столбца, как
+// после протягивания формулы вниз: =B1*C1-D1, =B2*C2-D1, =B3*C3-D1. Каждая
+// ссылка либо сдвигается вместе со строкой, либо одна и та же во всех формулах
+// серии, поэтому серию можно вычислить векторными циклами по срезам столбцов
+class ColumnRun {
+public:
+    // Серии короче выгоднее вычислять по одной формуле
+    static constexpr int MIN_SIZE = 16;
+
+    // Серия из одной формулы, записанной в ячейке pos
+    ColumnRun(Position pos, FormulaProgram program);
+
+    // Добавляет в серию формулу из следующей строки, если у неё та же форма.
+    // Иначе серия не меняется и возвращается false
+    bool TryAppend(Position pos, const FormulaProgram& program);
+
+    // Ячейка с первой формулой серии
+    Position GetFirst() const;
+    int GetSize() const;
+    // Формула первой строки серии
+    const FormulaProgram& GetProgram() const;
+    // Сдвигается ли вместе со строкой ссылка в операции program.ops[op].
+    // В серии из одной формулы все ссылки считаются неподвижными
+    bool IsRelative(std::size_t op) const;
+
+private:
+    Position first_;
+    int size_ = 1;
+    FormulaProgram program_;
+    // Для каждой операции Code::Cell: сдвигается ли ссылка вместе со строкой.
+    // Пока в серии одна формула, это неизвестно
+    std::vector<std::optional<bool>> relative_;
+};
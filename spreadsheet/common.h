@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <iosfwd>
 #include <memory>
 #include <stdexcept>
@@ -13,19 +14,57 @@ struct Position {
     int row = 0;
     int col = 0;
 
+    static constexpr int MAX_ROWS = 16384;
+    static constexpr int MAX_COLS = 16384;
+    // Максимальная длина текстовой записи позиции ("XFD16384") и количество букв в ней
+    static const int MAX_POSITION_LENGTH = 8;
+    static const int MAX_POS_LETTER_COUNT = 3;
+    static const Position NONE;
+
+    // Буфер, в который помещается текстовая запись любой валидной позиции
+    using Buffer = std::array<char, MAX_POSITION_LENGTH>;
+
     bool operator==(Position rhs) const;
     bool operator<(Position rhs) const;
 
     bool IsValid() const;
     std::string ToString() const;
+    // Записывает позицию в buffer без выделения памяти и возвращает записанный
+    // текст. Для невалидной позиции возвращает пустую строку
+    std::string_view ToString(Buffer& buffer) const;
 
-    static Position FromString(std::string_view str);
-
-    static const int MAX_ROWS = 16384;
-    static const int MAX_COLS = 16384;
-    static const Position NONE;
+    static constexpr Position FromString(std::string_view str);
 };
 
+// Разбирает позицию за один проход без выделения памяти. Может вычисляться на этапе компиляции
+constexpr Position Position::FromString(std::string_view str) {
+    constexpr Position none{ -1, -1 };
+    if (str.length() > MAX_POSITION_LENGTH || str.empty()) {
+        return none;
+    }
+
+    // Номер столбца записан заглавными буквами
+    std::size_t char_num = 0;
+    int col = 0;
+    for (; char_num < str.size() && str[char_num] >= 'A' && str[char_num] <= 'Z'; ++char_num) {
+        col = col * 26 + (str[char_num] - 'A' + 1);
+    }
+    if (char_num == 0 || char_num > MAX_POS_LETTER_COUNT || char_num == str.size()) {
+        return none;
+    }
+
+    // Номер строки - оставшиеся цифры
+    int row = 0;
+    for (; char_num < str.size(); ++char_num) {
+        if (str[char_num] < '0' || str[char_num] > '9') {
+            return none;
+        }
+        row = row * 10 + (str[char_num] - '0');
+    }
+    // Так как в программе нумерация с нуля, а у пользователя с единицы, вычитаем 1
+    return { row - 1, col - 1 };
+}
+
 struct Size {
     int rows = 0;
     int cols = 0;
@@ -81,6 +120,9 @@ public:
     // Либо текст ячейки, либо значение формулы, либо сообщение об ошибке из
     // формулы
     using Value = std::variant<std::string, double, FormulaError>;
+    // То же значение, но без копирования текста. Представление строки валидно
+    // до следующего изменения ячейки
+    using ValueView = std::variant<std::string_view, double, FormulaError>;
 
     virtual ~CellInterface() = default;
 
@@ -88,6 +130,8 @@ public:
     // В случае текстовой ячейки это её текст (без экранирующих символов). В
     // случае формулы - числовое значение формулы или сообщение об ошибке.
     virtual Value GetValue() const = 0;
+    // Аналог GetValue(), не выделяющий память под текст ячейки
+    virtual ValueView GetValueView() const = 0;
     // Возвращает внутренний текст ячейки, как если бы мы начали её
     // редактирование. В случае текстовой ячейки это её текст (возможно,
     // содержащий экранирующие символы). В случае формулы - её выражение.
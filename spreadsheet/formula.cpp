@@ -3,9 +3,12 @@
 #include "FormulaAST.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cctype>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 using namespace std::literals;
 
@@ -22,19 +25,18 @@ namespace {
         }
 
         Value Evaluate(const SheetInterface& sheet) const override {
-            // Лямба для получения значения по позиции, если ячейки не существует возвращает 0
-            auto cell_func = [&sheet](Position pos) {
-                if (sheet.GetCell(pos) == nullptr) {
-                    CellInterface::Value temp = 0.0;
-                    return temp;
-                }
-                else {
-                    return sheet.GetCell(pos)->GetValue();
-                }                
-            };
-            
+            // Ячейки читаются с листа по ходу вычисления, без выделения памяти под их список
             try {
-                return ast_.Execute(cell_func);
+                return ast_.Execute(sheet);
+            }
+            catch (FormulaError& er) {
+                return er;
+            }
+        }
+
+        Value Evaluate(const std::vector<const CellInterface*>& cells) const override {
+            try {
+                return ast_.Execute(cells);
             }
             catch (FormulaError& er) {
                 return er;
@@ -42,21 +44,23 @@ namespace {
         }
 
         std::string GetExpression() const override {
-            std::ostringstream out;            
-            ast_.PrintFormula(out);
-            return out.str();
+            return ast_.GetExpression();
         }
 
         bool operator<(const Position& rhs) const {
             return false;
         }
 
-        std::vector<Position> GetReferencedCells() const {
-            std::vector<Position> temp_cells = { ast_.GetCells().begin(), ast_.GetCells().end() };
-            std::sort(temp_cells.begin(), temp_cells.end());
-            temp_cells.erase(std::unique(temp_cells.begin(), temp_cells.end()), temp_cells.end());
+        const std::vector<Position>& GetReferencedCells() const override {
+            return ast_.GetCells();
+        }
+
+        FormulaProgram GetProgram() const override {
+            return ast_.GetProgram();
+        }
 
-            return temp_cells;
+        std::size_t GetMemoryUsage() const override {
+            return sizeof(*this) + ast_.GetMemoryUsage();
         }
 
     private:
@@ -73,4 +77,54 @@ std::unique_ptr<FormulaInterface> ParseFormula(std::string expression) {
     catch (...) {
         throw FormulaException("");
     }
+}
+
+std::vector<std::unique_ptr<FormulaInterface>> ParseFormulas(const std::vector<std::string>& expressions,
+    unsigned threads) {
+    std::vector<std::unique_ptr<FormulaInterface>> formulas(expressions.size());
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Выражения раздаются потокам пачками, чтобы потоки реже обращались к общему счётчику.
+    // У каждого потока свой парсер, см. ParseFormulaAST
+    constexpr std::size_t batch = 256;
+    std::atomic<std::size_t> next = 0;
+
+    auto worker = [&] {
+        for (std::size_t begin = next.fetch_add(batch); begin < expressions.size(); begin = next.fetch_add(batch)) {
+            const std::size_t end = std::min(begin + batch, expressions.size());
+            for (std::size_t i = begin; i < end; ++i) {
+                try {
+                    formulas[i] = std::make_unique<Formula>(expressions[i]);
+                }
+                catch (...) {
+                }
+            }
+        }
+    };
+
+    const std::size_t workers = std::min<std::size_t>(threads, (expressions.size() + batch - 1) / batch);
+    std::vector<std::thread> pool;
+    for (std::size_t i = 1; i < workers; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    return formulas;
+}
+
+void WarmUpFormulaParser() {
+    static std::once_flag warmed_up;
+    std::call_once(warmed_up, [] {
+        // Все виды чисел, ссылки, скобки, унарные знаки и сочетания операций
+        // разного приоритета в обоих порядках
+        for (const char* expression : {
+                 "1", "A1", "ZZ99+.5", "-(B2)", "+3.25e-2*C3", "1 + 2 - 3 * 4 / 5",
+                 "(A1-B2)/(C3+D4)*-E5", "1E3/-(2+3)-4*5+6", "((A1))", "A1*B2+C3*D4-E5/F6",
+                 "-A1*+2.0-(3)", "0.5e+1" }) {
+            ParseFormulaAST(expression);
+        }
+    });
 }
\ No newline at end of file
@@ -27,6 +27,9 @@ public:
     // возвращается именно эта ошибка. Если таких ошибок несколько, возвращается
     // любая.
     virtual Value Evaluate(const SheetInterface& sheet) const = 0;
+    // То же по уже найденным ячейкам: cells[i] - ячейка GetReferencedCells()[i]
+    // или nullptr, если её нет. Лист при вычислении не нужен
+    virtual Value Evaluate(const std::vector<const CellInterface*>& cells) const = 0;
 
     // Возвращает выражение, которое описывает формулу.
     // Не содержит пробелов и лишних скобок.
@@ -34,10 +37,29 @@ public:
 
     // Возвращает список ячеек, которые непосредственно задействованы в вычислении
     // формулы. Список отсортирован по возрастанию и не содержит повторяющихся
-    // ячеек.
-    virtual std::vector<Position> GetReferencedCells() const = 0;
+    // ячеек. Список строится при разборе формулы и не копируется.
+    virtual const std::vector<Position>& GetReferencedCells() const = 0;
+
+    // Возвращает формулу в обратной польской записи для многократного вычисления
+    // без обращений к листу
+    virtual FormulaProgram GetProgram() const = 0;
+
+    // Память, которую занимает формула вместе с деревом разбора и списком ячеек
+    virtual std::size_t GetMemoryUsage() const = 0;
 };
 
 // Парсит переданное выражение и возвращает объект формулы.
 // Бросает FormulaException в случае, если формула синтаксически некорректна.
-std::unique_ptr<FormulaInterface> ParseFormula(std::string expression);
\ No newline at end of file
+std::unique_ptr<FormulaInterface> ParseFormula(std::string expression);
+
+// Разбирает выражения параллельно в threads потоках, 0 - по числу ядер.
+// Результат i - формула из expressions[i] или nullptr, если выражение
+// синтаксически неверно. Разбор не обращается к листу, готовые формулы
+// устанавливаются в ячейки потом, см. Sheet::SetFormula
+std::vector<std::unique_ptr<FormulaInterface>> ParseFormulas(const std::vector<std::string>& expressions,
+    unsigned threads = 0);
+
+// Разбирает несколько типичных формул, чтобы заполнить общие для всех потоков
+// кэши лексера и парсера. Тогда первые формулы разбираются так же быстро, как
+// и последующие. Повторные вызовы ничего не делают
+void WarmUpFormulaParser();
\ No newline at end of file
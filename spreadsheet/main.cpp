@@ -1,6 +1,21 @@
+#include "boxed_value.h"
 #include "common.h"
 #include "formula.h"
+#include "scenario.h"
+#include "sheet.h"
 #include "test_runner_p.h"
+#include "trace.h"
+#include "workload.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 inline std::ostream& operator<<(std::ostream& output, Position pos) {
     return output << "(" << pos.row << ", " << pos.col << ")";
@@ -76,6 +91,20 @@ namespace {
         ASSERT(!Position::FromString("ABCDEFGHIJKLMNOPQRS8").IsValid());
     }
 
+    void TestPositionBufferConversion() {
+        static_assert(Position::FromString("XFD16384").row == Position::MAX_ROWS - 1);
+        static_assert(Position::FromString("XFD16384").col == Position::MAX_COLS - 1);
+        static_assert(Position::FromString("a1").row == -1);
+
+        Position::Buffer buffer;
+        for (Position pos : { Position{ 0, 0 }, Position{ 136, 2 }, Position{ 0, 702 },
+                              Position{ Position::MAX_ROWS - 1, Position::MAX_COLS - 1 } }) {
+            ASSERT_EQUAL(pos.ToString(buffer), pos.ToString());
+            ASSERT_EQUAL(Position::FromString(pos.ToString(buffer)), pos);
+        }
+        ASSERT(Position::NONE.ToString(buffer).empty());
+    }
+
     void TestEmpty() {
         auto sheet = CreateSheet();
         ASSERT_EQUAL(sheet->GetPrintableSize(), (Size{ 0, 0 }));
@@ -355,6 +384,920 @@ namespace {
         ASSERT_EQUAL(sheet->GetCell("M6"_pos)->GetText(), "Ready");
     }
 
+    void TestValueView() {
+        auto sheet = CreateSheet();
+        sheet->SetCell("A1"_pos, "'=text");
+        sheet->SetCell("A2"_pos, "12");
+        sheet->SetCell("A3"_pos, "=1/0");
+
+        const CellInterface* cell = sheet->GetCell("A1"_pos);
+        auto view = std::get<std::string_view>(cell->GetValueView());
+        ASSERT_EQUAL(view, "=text");
+        //     
+        ASSERT(view.data() == std::get<std::string_view>(cell->GetValueView()).data());
+
+        ASSERT_EQUAL(std::get<double>(sheet->GetCell("A2"_pos)->GetValueView()), 12);
+        ASSERT_EQUAL(std::get<FormulaError>(sheet->GetCell("A3"_pos)->GetValueView()),
+            FormulaError(FormulaError::Category::Div0));
+
+        const auto& concrete_sheet = static_cast<const Sheet&>(*sheet);
+        ASSERT_EQUAL(std::get<std::string_view>(concrete_sheet.GetValueView("A1"_pos)), "=text");
+        ASSERT(std::get<std::string_view>(concrete_sheet.GetValueView("J10"_pos)).empty());
+    }
+
+    void TestNumberCellText() {
+        auto sheet = CreateSheet();
+        auto check = [&](Position pos, std::string text, double value) {
+            sheet->SetCell(pos, text);
+            ASSERT_EQUAL(sheet->GetCell(pos)->GetText(), text);
+            ASSERT_EQUAL(std::get<double>(sheet->GetCell(pos)->GetValue()), value);
+        };
+
+        check("A1"_pos, "42", 42);
+        check("A2"_pos, "0.5", 0.5);
+        check("A3"_pos, "1.50", 1.5);
+        check("A4"_pos, "007", 7);
+        check("A5"_pos, "'12", 12);
+    }
+
+    void TestNumberRecognition() {
+        using CellImpl::ParseNumber;
+        ASSERT_EQUAL(ParseNumber("42").value(), 42);
+        ASSERT_EQUAL(ParseNumber("-1.5").value(), -1.5);
+        ASSERT_EQUAL(ParseNumber("+2").value(), 2);
+        ASSERT_EQUAL(ParseNumber(".25").value(), 0.25);
+        ASSERT_EQUAL(ParseNumber("3.").value(), 3);
+        ASSERT_EQUAL(ParseNumber("1e3").value(), 1000);
+        ASSERT_EQUAL(ParseNumber("2.5E-1").value(), 0.25);
+
+        for (std::string_view text : { "", ".", "-", "+", "+-1", "1.2.3", "1e", "1e+", " 1", "1 ",
+                                       "inf", "-nan", "0x10", "1,5", "1e400", "3D" }) {
+            ASSERT(!ParseNumber(text).has_value());
+        }
+
+        auto sheet = CreateSheet();
+        sheet->SetCell("A1"_pos, "1.2.3");
+        ASSERT_EQUAL(std::get<std::string>(sheet->GetCell("A1"_pos)->GetValue()), "1.2.3");
+        sheet->SetCell("A2"_pos, "-4");
+        sheet->SetCell("A3"_pos, "=A2*2");
+        ASSERT_EQUAL(std::get<double>(sheet->GetCell("A3"_pos)->GetValue()), -8);
+    }
+
+    void TestDiamondDependencies() {
+        auto sheet = CreateSheet();
+        sheet->SetCell("A1"_pos, "1");
+        sheet->SetCell("B1"_pos, "=A1+1");
+        sheet->SetCell("C1"_pos, "=A1*2");
+        sheet->SetCell("D1"_pos, "=B1+C1");
+        ASSERT_EQUAL(sheet->GetCell("D1"_pos)->GetValue(), CellInterface::Value(4.0));
+
+        sheet->SetCell("A1"_pos, "3");
+        ASSERT_EQUAL(sheet->GetCell("D1"_pos)->GetValue(), CellInterface::Value(10.0));
+
+        sheet->ClearCell("A1"_pos);
+        ASSERT_EQUAL(sheet->GetCell("D1"_pos)->GetValue(), CellInterface::Value(1.0));
+    }
+
+    void TestStringInterning() {
+        Sheet sheet;
+        for (int row = 0; row < 10; ++row) {
+            sheet.SetCell({ row, 0 }, row % 2 ? "done" : "pending");
+        }
+        sheet.SetCell({ 0, 1 }, "'12");
+        ASSERT_EQUAL(sheet.GetStringPoolStats().unique, 3u);
+        ASSERT_EQUAL(sheet.GetStringPoolStats().total, 11u);
+
+        //      
+        ASSERT(std::get<std::string_view>(sheet.GetValueView({ 0, 0 })).data()
+            == std::get<std::string_view>(sheet.GetValueView({ 2, 0 })).data());
+
+        sheet.ClearCell({ 0, 1 });
+        for (int row = 0; row < 10; row += 2) {
+            sheet.ClearCell({ row, 0 });
+        }
+        ASSERT_EQUAL(sheet.GetStringPoolStats().unique, 1u);
+        ASSERT_EQUAL(sheet.GetStringPoolStats().total, 5u);
+
+        sheet.SetCell({ 1, 0 }, "pending");
+        ASSERT_EQUAL(sheet.GetStringPoolStats().unique, 2u);
+        ASSERT_EQUAL(sheet.GetStringPoolStats().total, 5u);
+        ASSERT_EQUAL(sheet.GetCell({ 1, 0 })->GetText(), "pending");
+    }
+
+    void TestValueSnapshots() {
+        Sheet sheet;
+        sheet.SetCell("A1"_pos, "1");
+        sheet.SetCell("B1"_pos, "=A1*2");
+        //      
+        ASSERT(std::get<std::string_view>(sheet.ReadValues()->GetValue("B1"_pos)).empty());
+
+        sheet.PublishValues();
+        {
+            auto old_values = sheet.ReadValues();
+            sheet.SetCell("A1"_pos, "5");
+            sheet.SetCell("C100"_pos, "text");
+            sheet.PublishValues();
+
+            //    ,   
+            ASSERT_EQUAL(std::get<double>(old_values->GetValue("B1"_pos)), 2);
+            ASSERT(std::get<std::string_view>(old_values->GetValue("C100"_pos)).empty());
+
+            auto values = sheet.ReadValues();
+            ASSERT_EQUAL(std::get<double>(values->GetValue("B1"_pos)), 10);
+            ASSERT_EQUAL(std::get<std::string_view>(values->GetValue("C100"_pos)), "text");
+            ASSERT_EQUAL(values->GetPrintableSize(), (Size{ 100, 3 }));
+            ASSERT_EQUAL(values->GetVersion(), old_values->GetVersion() + 1);
+        }
+
+        sheet.ClearCell("C100"_pos);
+        sheet.PublishValues();
+        ASSERT(std::get<std::string_view>(sheet.ReadValues()->GetValue("C100"_pos)).empty());
+
+        //        : B1 = A1 * 2
+        std::atomic<bool> stop = false;
+        std::atomic<bool> consistent = true;
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; ++i) {
+            readers.emplace_back([&] {
+                while (!stop) {
+                    auto values = sheet.ReadValues();
+                    const double a1 = std::get<double>(values->GetValue("A1"_pos));
+                    if (std::get<double>(values->GetValue("B1"_pos)) != a1 * 2) {
+                        consistent = false;
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < 2000; ++i) {
+            sheet.SetCell("A1"_pos, std::to_string(i));
+            sheet.PublishValues();
+        }
+        stop = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        ASSERT(consistent);
+    }
+
+    void TestSheetClone() {
+        Sheet sheet;
+        sheet.SetCell("A1"_pos, "1");
+        sheet.SetCell("A2"_pos, "text");
+        sheet.SetCell("B1"_pos, "=A1*2");
+        sheet.SetCell("CV100"_pos, "=B1+1");
+
+        auto clone = sheet.Clone();
+        clone->SetCell("A1"_pos, "10");
+        clone->ClearCell("A2"_pos);
+
+        //       ,  
+        ASSERT_EQUAL(sheet.GetCell("CV100"_pos)->GetValue(), CellInterface::Value(3.0));
+        ASSERT_EQUAL(clone->GetCell("CV100"_pos)->GetValue(), CellInterface::Value(21.0));
+        ASSERT_EQUAL(sheet.GetCell("A2"_pos)->GetText(), "text");
+        ASSERT(clone->GetCell("A2"_pos) == nullptr);
+
+        sheet.SetCell("A1"_pos, "=5");
+        ASSERT_EQUAL(sheet.GetCell("CV100"_pos)->GetValue(), CellInterface::Value(11.0));
+        ASSERT_EQUAL(clone->GetCell("CV100"_pos)->GetValue(), CellInterface::Value(21.0));
+        ASSERT_EQUAL(clone->GetCell("B1"_pos)->GetText(), "=A1*2");
+
+        //      
+        clone->SetCell("A1"_pos, "=1");
+        try {
+            clone->SetCell("A1"_pos, "=CV100");
+            ASSERT(false);
+        } catch (const CircularDependencyException&) {
+        }
+
+        //     
+        auto clone2 = clone->Clone();
+        clone2->ClearCell("CV100"_pos);
+        ASSERT_EQUAL(clone2->GetPrintableSize(), (Size{ 1, 2 }));
+        ASSERT_EQUAL(clone->GetPrintableSize(), (Size{ 100, 100 }));
+
+        //    
+        clone2->PublishValues();
+        ASSERT_EQUAL(std::get<double>(clone2->ReadValues()->GetValue("B1"_pos)), 2);
+
+        std::ostringstream values;
+        clone2->PrintValues(values);
+        ASSERT_EQUAL(values.str(), "1\t2\n");
+
+        //           ,    
+        Sheet chained;
+        chained.SetCell("A1"_pos, "1");
+        chained.SetCell("A100"_pos, "=A1");
+        chained.SetCell("B100"_pos, "=A100+1");
+        auto chained_clone = chained.Clone();
+        chained_clone->SetCell("A1"_pos, "2");
+        ASSERT_EQUAL(chained_clone->GetCell("B100"_pos)->GetValue(), CellInterface::Value(3.0));
+        ASSERT_EQUAL(chained.GetCell("B100"_pos)->GetValue(), CellInterface::Value(2.0));
+        chained.SetCell("A1"_pos, "5");
+        ASSERT_EQUAL(chained.GetCell("B100"_pos)->GetValue(), CellInterface::Value(6.0));
+        ASSERT_EQUAL(chained_clone->GetCell("B100"_pos)->GetValue(), CellInterface::Value(3.0));
+    }
+
+    void TestScenarioEvaluator() {
+        Sheet sheet;
+        sheet.SetCell("A1"_pos, "100");
+        sheet.SetCell("A2"_pos, "0.1");
+        sheet.SetCell("A3"_pos, "text");
+        sheet.SetCell("B1"_pos, "=A1*(1+A2)");
+        sheet.SetCell("B2"_pos, "=B1/(A2-0.5)");
+        sheet.SetCell("B3"_pos, "=B1+A3");
+        sheet.SetCell("C1"_pos, "=-B2+Z9");
+        sheet.SetCell("D1"_pos, "=A1*2");
+
+        ScenarioEvaluator evaluator(sheet, { "A2"_pos }, { "C1"_pos, "B3"_pos, "D1"_pos, "A3"_pos, "A2"_pos });
+        // D1     
+        ASSERT_EQUAL(evaluator.GetFormulaCount(), 4u);
+
+        const std::vector<std::vector<double>> scenarios = { { 0.1 }, { 0.5 }, { -1 }, { 2 } };
+        const auto results = evaluator.Evaluate(scenarios, 2);
+        ASSERT_EQUAL(results.size(), scenarios.size());
+
+        //     
+        for (std::size_t i = 0; i < scenarios.size(); ++i) {
+            auto clone = sheet.Clone();
+            clone->SetCell("A2"_pos, std::to_string(scenarios[i][0]));
+            const std::vector<CellInterface::Value> expected = {
+                clone->GetCell("C1"_pos)->GetValue(), clone->GetCell("B3"_pos)->GetValue(),
+                clone->GetCell("D1"_pos)->GetValue(), clone->GetCell("A3"_pos)->GetValue(),
+                clone->GetCell("A2"_pos)->GetValue(),
+            };
+            ASSERT(results[i] == expected);
+        }
+        ASSERT_EQUAL(results[1][0], CellInterface::Value(FormulaError(FormulaError::Category::Div0)));
+
+        //   
+        ASSERT_EQUAL(sheet.GetCell("A2"_pos)->GetText(), "0.1");
+
+        try {
+            evaluator.Evaluate({ { 1, 2 } });
+            ASSERT(false);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+
+    void TestEarlyCutoff() {
+        Sheet sheet;
+        sheet.SetCell("A1"_pos, "1");
+        sheet.SetCell("B1"_pos, "=A1*0");
+        sheet.SetCell("C1"_pos, "=B1+1");
+        sheet.SetCell("D1"_pos, "=C1*2+A1");
+        auto stats = sheet.GetRecalcStats();
+
+        // B1  ,  C1   ,  D1   A1
+        sheet.SetCell("A1"_pos, "5");
+        ASSERT_EQUAL(sheet.GetRecalcStats().evaluated - stats.evaluated, 2u);
+        ASSERT_EQUAL(sheet.GetRecalcStats().skipped - stats.skipped, 1u);
+        ASSERT_EQUAL(sheet.GetCell("D1"_pos)->GetValue(), CellInterface::Value(7.0));
+
+        //  A1 :     
+        stats = sheet.GetRecalcStats();
+        sheet.SetCell("A1"_pos, "=10/2");
+        ASSERT_EQUAL(sheet.GetRecalcStats().evaluated - stats.evaluated, 1u);
+        ASSERT_EQUAL(sheet.GetRecalcStats().skipped - stats.skipped, 3u);
+
+        //    
+        sheet.ClearCell("A1"_pos);
+        ASSERT_EQUAL(sheet.GetCell("D1"_pos)->GetValue(), CellInterface::Value(2.0));
+        sheet.SetCell("A1"_pos, "");
+        ASSERT_EQUAL(sheet.GetCell("D1"_pos)->GetValue(), CellInterface::Value(2.0));
+        sheet.SetCell("A1"_pos, "text");
+        ASSERT_EQUAL(sheet.GetCell("D1"_pos)->GetValue(),
+            CellInterface::Value(FormulaError(FormulaError::Category::Value)));
+
+        // B1  A1  ,   C1:   C1
+        for (bool share : { false, true }) {
+            Sheet diamond;
+            if (share) {
+                diamond.ShareSubexpressions();
+            }
+            diamond.SetCell("A1"_pos, "1");
+            diamond.SetCell("C1"_pos, "=A1");
+            diamond.SetCell("B1"_pos, "=A1+C1");
+            diamond.SetCell("A1"_pos, "2");
+            ASSERT_EQUAL(diamond.GetCell("B1"_pos)->GetValue(), CellInterface::Value(4.0));
+            diamond.ClearCell("A1"_pos);
+            ASSERT_EQUAL(diamond.GetCell("B1"_pos)->GetValue(), CellInterface::Value(0.0));
+        }
+    }
+
+    void TestDependencyEdgesRemoval() {
+        Sheet sheet;
+        sheet.SetCell("A1"_pos, "1");
+        sheet.SetCell("C1"_pos, "1");
+        //      A1:     
+        auto recalc_work = [&sheet](std::string value) {
+            const auto before = sheet.GetRecalcStats();
+            sheet.SetCell("A1"_pos, std::move(value));
+            const auto after = sheet.GetRecalcStats();
+            return (after.evaluated - before.evaluated) + (after.skipped - before.skipped);
+        };
+
+        sheet.SetCell("B1"_pos, "=A1+A1");
+        const auto initial_work = recalc_work("2");
+        ASSERT_EQUAL(initial_work, 1u);
+
+        for (int i = 0; i < 100; ++i) {
+            sheet.SetCell("B1"_pos, "=C1+1");
+            sheet.SetCell("B1"_pos, "=A1*" + std::to_string(i));
+        }
+        ASSERT_EQUAL(recalc_work("3"), initial_work);
+
+        //     A1
+        sheet.SetCell("B1"_pos, "=C1*2");
+        ASSERT_EQUAL(recalc_work("4"), 0u);
+        sheet.SetCell("D1"_pos, "=B1+A1");
+        sheet.ClearCell("D1"_pos);
+        ASSERT_EQUAL(recalc_work("5"), 0u);
+        ASSERT_EQUAL(sheet.GetCell("B1"_pos)->GetValue(), CellInterface::Value(2.0));
+    }
+
+    void TestReferencedCellsOrder() {
+        ASSERT("B1"_pos < "A2"_pos);
+        ASSERT("A1"_pos < "B1"_pos);
+        ASSERT(!("A2"_pos < "B1"_pos));
+        ASSERT(!("A1"_pos < "A1"_pos));
+
+        auto formula = ParseFormula("A2+C1+B1+A2*C1");
+        const auto& cells = formula->GetReferencedCells();
+        ASSERT_EQUAL(cells, (std::vector{ "B1"_pos, "C1"_pos, "A2"_pos }));
+        //    ,      
+        ASSERT(&cells == &formula->GetReferencedCells());
+        ASSERT_EQUAL(formula->GetExpression(), "A2+C1+B1+A2*C1");
+    }
+
+    void TestFormulaConstantFolding() {
+        //    ,   ,  
+        //  ,    
+        auto seconds = ParseFormula("A1/(60*60*24)");
+        ASSERT_EQUAL(seconds->GetExpression(), "A1/(60*60*24)");
+        ASSERT_EQUAL(seconds->GetProgram().ops.size(), 3u);
+
+        auto signs = ParseFormula("+(-(-B2))");
+        ASSERT_EQUAL(signs->GetExpression(), "+--B2");
+        ASSERT_EQUAL(signs->GetProgram().ops.size(), 1u);
+
+        ASSERT_EQUAL(ParseFormula("A1*1/1-0")->GetProgram().ops.size(), 1u);
+        ASSERT_EQUAL(ParseFormula("-(2*3)")->GetProgram().ops.size(), 1u);
+        // -0+0  +0,    
+        ASSERT_EQUAL(ParseFormula("A1+0")->GetProgram().ops.size(), 3u);
+
+        auto sheet = CreateSheet();
+        sheet->SetCell("A1"_pos, "2");
+        sheet->SetCell("B2"_pos, "3");
+        sheet->SetCell("C1"_pos, "=A1/(60*60*24)");
+        sheet->SetCell("C2"_pos, "=+(-(-B2))");
+        ASSERT_EQUAL(std::get<double>(sheet->GetCell("C1"_pos)->GetValue()), 2.0 / 86400);
+        ASSERT_EQUAL(std::get<double>(sheet->GetCell("C2"_pos)->GetValue()), 3);
+        ASSERT_EQUAL(sheet->GetCell("C1"_pos)->GetText(), "=A1/(60*60*24)");
+
+        //        
+        sheet->SetCell("C3"_pos, "=(1/0)*0");
+        ASSERT_EQUAL(std::get<FormulaError>(sheet->GetCell("C3"_pos)->GetValue()),
+            FormulaError(FormulaError::Category::Div0));
+        sheet->SetCell("D1"_pos, "text");
+        sheet->SetCell("C4"_pos, "=D1*1");
+        ASSERT_EQUAL(std::get<FormulaError>(sheet->GetCell("C4"_pos)->GetValue()),
+            FormulaError(FormulaError::Category::Value));
+    }
+
+    void TestSharedSubexpressions() {
+        Sheet sheet;
+        ASSERT_EQUAL(sheet.GetSubexpressionStats().nodes, 0u);
+
+        sheet.SetCell("B2"_pos, "5");
+        sheet.SetCell("C2"_pos, "3");
+        sheet.SetCell("D2"_pos, "=(B2-C2)*2");
+        // ,    ,    
+        sheet.ShareSubexpressions();
+        sheet.SetCell("E2"_pos, "=(B2-C2)*3");
+        sheet.SetCell("F2"_pos, "=(B2-C2)/4+1");
+
+        // B2, C2, B2-C2          
+        auto stats = sheet.GetSubexpressionStats();
+        ASSERT_EQUAL(stats.nodes, 11u);
+        ASSERT_EQUAL(stats.shared, 1u);
+        ASSERT_EQUAL(sheet.GetCell("F2"_pos)->GetValue(), CellInterface::Value(1.5));
+
+        // B2-C2    ,    
+        sheet.SetCell("B2"_pos, "9");
+        ASSERT_EQUAL(sheet.GetSubexpressionStats().reused, stats.reused + 2);
+        ASSERT_EQUAL(sheet.GetCell("D2"_pos)->GetValue(), CellInterface::Value(12.0));
+        ASSERT_EQUAL(sheet.GetCell("E2"_pos)->GetValue(), CellInterface::Value(18.0));
+        ASSERT_EQUAL(sheet.GetCell("F2"_pos)->GetValue(), CellInterface::Value(2.5));
+
+        //    
+        sheet.SetCell("C2"_pos, "x");
+        const CellInterface::Value value_error = FormulaError(FormulaError::Category::Value);
+        ASSERT_EQUAL(sheet.GetCell("D2"_pos)->GetValue(), value_error);
+        ASSERT_EQUAL(sheet.GetCell("F2"_pos)->GetValue(), value_error);
+        sheet.SetCell("C2"_pos, "3");
+
+        // ,     , 
+        sheet.ClearCell("E2"_pos);
+        ASSERT_EQUAL(sheet.GetSubexpressionStats().nodes, 9u);
+        sheet.SetCell("D2"_pos, "=7");
+        ASSERT_EQUAL(sheet.GetSubexpressionStats().nodes, 8u);
+        ASSERT_EQUAL(sheet.GetSubexpressionStats().shared, 0u);
+        ASSERT_EQUAL(sheet.GetCell("D2"_pos)->GetValue(), CellInterface::Value(7.0));
+
+        //    
+        auto clone = sheet.Clone();
+        clone->SetCell("B2"_pos, "7");
+        ASSERT_EQUAL(clone->GetCell("F2"_pos)->GetValue(), CellInterface::Value(2.0));
+        ASSERT_EQUAL(sheet.GetCell("F2"_pos)->GetValue(), CellInterface::Value(2.5));
+        ASSERT_EQUAL(clone->GetSubexpressionStats().nodes, sheet.GetSubexpressionStats().nodes);
+    }
+
+    void TestFormulaCellBinding() {
+        auto sheet = CreateSheet();
+        sheet->SetCell("B1"_pos, "4");
+
+        //     GetReferencedCells(): B1, A2
+        auto formula = ParseFormula("A2*10+B1");
+        ASSERT_EQUAL(std::get<double>(formula->Evaluate({ sheet->GetCell("B1"_pos), nullptr })), 4);
+        ASSERT_EQUAL(std::get<double>(formula->Evaluate(*sheet)), 4);
+
+        sheet->SetCell("A1"_pos, "1");
+        sheet->SetCell("C1"_pos, "=A1+A1*2+B1");
+        sheet->SetCell("A1"_pos, "3");
+        ASSERT_EQUAL(sheet->GetCell("C1"_pos)->GetValue(), CellInterface::Value(13.0));
+
+        //         
+        sheet->ClearCell("A1"_pos);
+        ASSERT_EQUAL(sheet->GetCell("C1"_pos)->GetValue(), CellInterface::Value(4.0));
+        sheet->SetCell("A1"_pos, "5");
+        ASSERT_EQUAL(sheet->GetCell("C1"_pos)->GetValue(), CellInterface::Value(19.0));
+
+        //           
+        Sheet original;
+        original.SetCell("A1"_pos, "1");
+        original.SetCell("B1"_pos, "=A1*2");
+        auto clone = original.Clone();
+        clone->SetCell("A1"_pos, "10");
+        original.SetCell("A1"_pos, "100");
+        ASSERT_EQUAL(clone->GetCell("B1"_pos)->GetValue(), CellInterface::Value(20.0));
+        ASSERT_EQUAL(original.GetCell("B1"_pos)->GetValue(), CellInterface::Value(200.0));
+        clone->SetCell("A1"_pos, "7");
+        ASSERT_EQUAL(clone->GetCell("B1"_pos)->GetValue(), CellInterface::Value(14.0));
+        ASSERT_EQUAL(original.GetCell("B1"_pos)->GetValue(), CellInterface::Value(200.0));
+    }
+
+    void TestBoxedValue() {
+        ASSERT(BoxedValue().IsEmpty());
+        ASSERT(!BoxedValue().IsNumber());
+
+        for (double number : { 0.0, -0.0, 1.5, -1e300, std::numeric_limits<double>::infinity(),
+                               std::numeric_limits<double>::denorm_min() }) {
+            const BoxedValue value(number);
+            ASSERT(value.IsNumber());
+            ASSERT(!value.IsError());
+            ASSERT_EQUAL(value.GetNumber(), number);
+            ASSERT_EQUAL(std::signbit(value.GetNumber()), std::signbit(number));
+        }
+
+        for (auto category : { FormulaError::Category::Ref, FormulaError::Category::Value,
+                               FormulaError::Category::Div0 }) {
+            const BoxedValue value{ FormulaError(category) };
+            ASSERT(value.IsError());
+            ASSERT_EQUAL(value.GetError(), FormulaError(category));
+            ASSERT_EQUAL(std::get<FormulaError>(value.ToValue()), FormulaError(category));
+        }
+
+        //  NaN,        ,  
+        for (std::uint64_t bits : { 0xFFF8'0000'0000'0000ull, 0xFFF9'0000'0000'0001ull,
+                                    0xFFFA'0000'0000'0000ull, 0x7FF0'0000'0000'0001ull }) {
+            double nan = 0.0;
+            std::memcpy(&nan, &bits, sizeof(nan));
+            const BoxedValue value(nan);
+            ASSERT(value.IsNumber());
+            ASSERT(std::isnan(value.GetNumber()));
+        }
+        ASSERT_EQUAL(sizeof(BoxedValue), 8u);
+    }
+
+    void TestColumnRuns() {
+        Sheet sheet;
+        std::vector<Position> outputs;
+        for (int row = 1; row <= 40; ++row) {
+            const std::string r = std::to_string(row);
+            const std::string next = std::to_string(row + 1);
+            sheet.SetCell(Position::FromString("B" + r), r);
+            sheet.SetCell(Position::FromString("C" + r), std::to_string(row % 4));
+            //  20     E   
+            sheet.SetCell(Position::FromString("E" + r), row == 20 ? "=B20+C20" : "=B" + r + "*C" + r + "-D1");
+            sheet.SetCell(Position::FromString("F" + r), "=(B" + r + "-D1)/C" + r);
+            //  :    ,  1/inf 
+            sheet.SetCell(Position::FromString("G" + r), "=1/(E" + r + "/0)+F" + r);
+            sheet.SetCell(Position::FromString("H" + r), "=E" + next + "-B" + r);
+            for (const char* col : { "E", "F", "G", "H" }) {
+                outputs.push_back(Position::FromString(col + r));
+            }
+        }
+        sheet.SetCell("C7"_pos, "text");
+        //       
+        for (const char* pos : { "I1", "I2", "I3" }) {
+            sheet.SetCell(Position::FromString(pos), "=D1*2");
+            outputs.push_back(Position::FromString(pos));
+        }
+
+        ScenarioEvaluator evaluator(sheet, { "D1"_pos }, outputs);
+        // E20  H19  D1  
+        ASSERT_EQUAL(evaluator.GetFormulaCount(), 160u);
+        ASSERT_EQUAL(evaluator.GetVectorizedCount(), 157u);
+
+        const std::vector<std::vector<double>> scenarios = { { 0 }, { 2.5 }, { -1 }, { 11 } };
+        const auto results = evaluator.Evaluate(scenarios);
+        for (std::size_t i = 0; i < scenarios.size(); ++i) {
+            auto clone = sheet.Clone();
+            clone->SetCell("D1"_pos, std::to_string(scenarios[i][0]));
+            for (std::size_t j = 0; j < outputs.size(); ++j) {
+                ASSERT_EQUAL(results[i][j], clone->GetCell(outputs[j])->GetValue());
+            }
+        }
+        // F4 = (4 - D1) / 0, E7 = 7 * "text" - D1
+        const std::size_t f4 = 3 * 4 + 1;
+        const std::size_t e7 = 6 * 4;
+        ASSERT_EQUAL(results[0][f4], CellInterface::Value(FormulaError(FormulaError::Category::Div0)));
+        ASSERT_EQUAL(results[0][e7], CellInterface::Value(FormulaError(FormulaError::Category::Value)));
+    }
+
+    void TestFormulaParserReuse() {
+        WarmUpFormulaParser();
+        WarmUpFormulaParser();
+
+        // ,  ,   
+        for (const char* expression : { "1+", "A1**2", "(", "1e", "A1 B2" }) {
+            try {
+                ParseFormula(expression);
+                ASSERT(false);
+            } catch (const FormulaException&) {
+            }
+            ASSERT_EQUAL(ParseFormula("(A1+2)*B3")->GetExpression(), "(A1+2)*B3");
+        }
+
+        //     
+        std::atomic<int> mismatches = 0;
+        std::vector<std::thread> threads;
+        for (int t = 1; t <= 4; ++t) {
+            threads.emplace_back([&mismatches, t] {
+                for (int i = 0; i < 200; ++i) {
+                    const std::string expression = "A" + std::to_string(t) + "*" + std::to_string(i) + "-B1";
+                    if (ParseFormula(expression)->GetExpression() != expression) {
+                        ++mismatches;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        ASSERT_EQUAL(mismatches.load(), 0);
+    }
+
+    void TestParallelParsing() {
+        std::vector<std::string> expressions;
+        for (int i = 0; i < 2000; ++i) {
+            expressions.push_back(i % 100 == 7 ? "1+"
+                : "A" + std::to_string(i % 50 + 1) + "*" + std::to_string(i) + "+(B1-C" + std::to_string(i % 9 + 1) + ")");
+        }
+        const auto formulas = ParseFormulas(expressions, 4);
+        ASSERT_EQUAL(formulas.size(), expressions.size());
+        for (std::size_t i = 0; i < expressions.size(); ++i) {
+            if (i % 100 == 7) {
+                ASSERT(!formulas[i]);
+            } else {
+                ASSERT_EQUAL(formulas[i]->GetExpression(), ParseFormula(expressions[i])->GetExpression());
+            }
+        }
+
+        // SetCells    ,   SetCell  
+        std::vector<std::pair<Position, std::string>> cells;
+        for (int row = 0; row < 600; ++row) {
+            const std::string r = std::to_string(row + 1);
+            cells.push_back({ { row, 0 }, r });
+            cells.push_back({ { row, 1 }, "=A" + r + "*2" + (row > 0 ? "+B" + std::to_string(row) : "") });
+            cells.push_back({ { row, 2 }, "'=text" });
+        }
+        cells.push_back({ "A1"_pos, "=10/4" });
+        Sheet parallel;
+        parallel.SetCells(cells, 4);
+        Sheet sequential;
+        for (const auto& [pos, text] : cells) {
+            sequential.SetCell(pos, text);
+        }
+        for (const auto& [pos, text] : cells) {
+            ASSERT_EQUAL(parallel.GetCell(pos)->GetText(), sequential.GetCell(pos)->GetText());
+            ASSERT_EQUAL(parallel.GetCell(pos)->GetValue(), sequential.GetCell(pos)->GetValue());
+        }
+
+        //    ,   - 
+        Sheet sheet;
+        try {
+            sheet.SetCells({ { "A1"_pos, "=1+2" }, { "A2"_pos, "=1+" }, { "A3"_pos, "3" } });
+            ASSERT(false);
+        } catch (const FormulaException&) {
+        }
+        ASSERT_EQUAL(sheet.GetCell("A1"_pos)->GetValue(), CellInterface::Value(3.0));
+        ASSERT(sheet.GetCell("A3"_pos) == nullptr);
+        try {
+            sheet.SetCells({ { "B1"_pos, "=B2" }, { "B2"_pos, "=B1" } });
+            ASSERT(false);
+        } catch (const CircularDependencyException&) {
+        }
+        ASSERT_EQUAL(sheet.GetCell("B1"_pos)->GetText(), "=B2");
+        try {
+            sheet.SetFormula("C1"_pos, nullptr);
+            ASSERT(false);
+        } catch (const FormulaException&) {
+        }
+    }
+
+    void TestWorkloadGenerator() {
+        //   -     
+        ASSERT(WorkloadGenerator(5).RandomDag({ 50, 10 }, 300, 0.6, 4) == WorkloadGenerator(5).RandomDag({ 50, 10 }, 300, 0.6, 4));
+        ASSERT(!(WorkloadGenerator(5).Edits({ 50, 10 }, 100) == WorkloadGenerator(6).Edits({ 50, 10 }, 100)));
+
+        auto chain = CreateSheet();
+        ASSERT_EQUAL(ApplyWorkload(*chain, WorkloadGenerator(1).Chain(100)), 0u);
+        ASSERT_EQUAL(chain->GetCell("A100"_pos)->GetValue(), CellInterface::Value(100.0));
+        //    ,     
+        const auto long_chain = WorkloadGenerator(1).Chain(Position::MAX_ROWS + 1);
+        ASSERT_EQUAL(long_chain.back().pos, "B1"_pos);
+        ASSERT_EQUAL(long_chain.back().text, "=A16384+1");
+
+        const auto dag = WorkloadGenerator(2).RandomDag({ 40, 8 }, 320, 0.5, 3);
+        std::stringstream ops;
+        WriteWorkload(dag, ops);
+        ASSERT(ReadWorkload(ops) == dag);
+        for (const char* line : { "set\tA1", "clear\tA1\t1", "put\tA1\t1", "set\tA0\t1" }) {
+            try {
+                std::istringstream in(line);
+                ReadWorkload(in);
+                ASSERT(false);
+            } catch (const std::invalid_argument&) {
+            }
+        }
+        try {
+            WorkloadGenerator(1).Layout({ Position::MAX_ROWS + 1, 1 }, 0.5);
+            ASSERT(false);
+        } catch (const std::invalid_argument&) {
+        }
+        //  :      
+        const auto dense = WorkloadGenerator(4).Layout({ 10, 10 }, 0.9);
+        ASSERT_EQUAL(dense.size(), 90u);
+        std::set<Position> dense_positions;
+        for (const WorkloadOp& op : dense) {
+            ASSERT(op.pos.row < 10 && op.pos.col < 10);
+            dense_positions.insert(op.pos);
+        }
+        ASSERT_EQUAL(dense_positions.size(), 90u);
+
+        //       ,    
+        WorkloadGenerator generator(3);
+        const Size size{ 30, 6 };
+        auto edited = CreateSheet();
+        ASSERT_EQUAL(ApplyWorkload(*edited, generator.RandomDag(size, 120, 0.5, 3)), 0u);
+        ASSERT(ApplyWorkload(*edited, generator.Edits(size, 2000)) > 0u);
+        std::stringstream tsv;
+        edited->PrintTexts(tsv);
+        auto rebuilt = CreateSheet();
+        ASSERT_EQUAL(ApplyWorkload(*rebuilt, ReadTsv(tsv)), 0u);
+
+        auto value = [](const SheetInterface& sheet, Position pos) {
+            const CellInterface* cell = sheet.GetCell(pos);
+            return cell ? cell->GetValue() : CellInterface::Value();
+        };
+        for (int row = 0; row < size.rows; ++row) {
+            for (int col = 0; col < size.cols; ++col) {
+                ASSERT_EQUAL(value(*edited, { row, col }), value(*rebuilt, { row, col }));
+            }
+        }
+    }
+
+    void TestTraceReplay() {
+        using Kind = WorkloadOp::Kind;
+
+        Sheet sheet;
+        //      GetCell,      
+        sheet.ShareSubexpressions();
+        std::stringstream trace;
+        sheet.StartTrace(trace);
+        sheet.SetCell("A1"_pos, "2");
+        sheet.SetCell("B1"_pos, "=A1*3");
+        sheet.GetCell("B1"_pos);
+        try {
+            sheet.SetCell("A1"_pos, "=B1");
+        } catch (const CircularDependencyException&) {
+        }
+        sheet.SetCells({ { "C1"_pos, "=A1+B1" }, { "D1"_pos, "text" } });
+        sheet.ClearCell("D1"_pos);
+        try {
+            sheet.GetCell(Position::NONE);
+        } catch (const InvalidPositionException&) {
+        }
+        std::ostringstream texts;
+        sheet.PrintTexts(texts);
+        //      ,     
+        ScenarioEvaluator evaluator(sheet, { "A1"_pos }, { "C1"_pos, "B1"_pos, "E1"_pos });
+        ASSERT_EQUAL(sheet.StopTrace(), 7u);
+        ASSERT_EQUAL(sheet.StopTrace(), 0u);
+        const std::size_t trace_size = trace.str().size();
+        sheet.SetCell("E1"_pos, "1");
+        ASSERT_EQUAL(trace.str().size(), trace_size);
+
+        const auto ops = ReadTrace(trace);
+        const std::vector<WorkloadOp> expected{
+            { Kind::Set, "A1"_pos, "2" },
+            { Kind::Set, "B1"_pos, "=A1*3" },
+            { Kind::Get, "B1"_pos, "" },
+            { Kind::Set, "A1"_pos, "=B1" },
+            { Kind::Set, "C1"_pos, "=A1+B1" },
+            { Kind::Set, "D1"_pos, "text" },
+            { Kind::Clear, "D1"_pos, "" },
+        };
+        ASSERT(ops == expected);
+
+        Sheet replayed;
+        const auto stats = ReplayTrace(replayed, ops);
+        ASSERT_EQUAL(stats.rejected, 1u);
+        ASSERT_EQUAL(stats.Get(Kind::Set).count, 5u);
+        ASSERT_EQUAL(stats.Get(Kind::Clear).count, 1u);
+        ASSERT_EQUAL(stats.Get(Kind::Get).count, 1u);
+        const auto& set = stats.Get(Kind::Set);
+        ASSERT(set.p50 <= set.p99 && set.p99 <= set.p999 && set.p999 <= set.max);
+        ASSERT(stats.GetThroughput() > 0.0);
+        ASSERT_EQUAL(replayed.GetCell("C1"_pos)->GetValue(), CellInterface::Value(8.0));
+
+        //        ,  - 
+        const auto edits = WorkloadGenerator(4).Edits({ 20, 5 }, 500);
+        std::stringstream binary;
+        WriteTrace(edits, binary);
+        ASSERT(ReadTrace(binary) == edits);
+        std::string data = binary.str();
+        for (const std::string& broken : { data.substr(0, data.size() - 1), std::string("set\tA1\t1\n") }) {
+            try {
+                std::istringstream in(broken);
+                ReadTrace(in);
+                ASSERT(false);
+            } catch (const std::invalid_argument&) {
+            }
+        }
+    }
+
+    void TestSheetMetrics() {
+        Sheet sheet;
+        sheet.SetCell("A1"_pos, "1");
+        sheet.SetCell("B1"_pos, "=A1+1");
+        sheet.SetCell("C1"_pos, "=B1*2");
+        sheet.SetCell("D1"_pos, "=A1+C1");
+        try {
+            sheet.SetCell("A1"_pos, "=D1");
+        } catch (const CircularDependencyException&) {
+        }
+        //  A1    A1 -> B1 -> C1 -> D1
+        sheet.SetCell("A1"_pos, "5");
+        sheet.ClearCell("C1"_pos);
+
+        const SheetMetrics& metrics = sheet.GetMetrics();
+        if constexpr (SheetMetrics::ENABLED) {
+            ASSERT_EQUAL(metrics.change.count, 7u);
+            ASSERT_EQUAL(metrics.parse.count, 4u);
+            ASSERT_EQUAL(metrics.cycle_check.count, 4u);
+            ASSERT_EQUAL(metrics.evaluate.count, 3u);
+            ASSERT_EQUAL(metrics.evaluations, sheet.GetRecalcStats().evaluated);
+            ASSERT_EQUAL(metrics.invalidated, 4u);
+            ASSERT_EQUAL(metrics.max_cascade_depth, 3u);
+            ASSERT(metrics.change.time >= metrics.parse.time);
+        }
+        else {
+            ASSERT_EQUAL(metrics.change.count, 0u);
+            ASSERT_EQUAL(metrics.evaluations, 0u);
+        }
+
+        std::ostringstream json;
+        metrics.WriteJson(json);
+        ASSERT_EQUAL(json.str().substr(0, 11), "{\"enabled\":");
+        ASSERT(json.str().find("\"cycle_check\":{\"count\":") != std::string::npos);
+        ASSERT_EQUAL(json.str().back(), '}');
+
+        sheet.ResetMetrics();
+        ASSERT_EQUAL(sheet.GetMetrics().change.count, 0u);
+        ASSERT_EQUAL(sheet.GetMetrics().max_cascade_depth, 0u);
+    }
+
+    void TestCellProfiler() {
+        Sheet sheet;
+        sheet.SetCell("A1"_pos, "1");
+        sheet.SetCell("B1"_pos, "=A1*2");
+        sheet.SetCell("C1"_pos, "=B1+1");
+        sheet.SetCell("D1"_pos, "=C1+B1");
+        sheet.SetCell("E1"_pos, "=A1+5");
+        sheet.SetCell("A2"_pos, "2");
+        sheet.SetCell("B2"_pos, "=A2");
+        ASSERT(sheet.GetProfile().GetHotCells(10).empty());
+
+        sheet.StartProfiling();
+        sheet.SetCell("A1"_pos, "3");
+        sheet.SetCell("A1"_pos, "4");
+        sheet.SetCell("A2"_pos, "5");
+        sheet.SetCell("F1"_pos, "=D1*2");
+        sheet.StopProfiling();
+        sheet.SetCell("A1"_pos, "5");
+
+        const CellProfiler& profile = sheet.GetProfile();
+        const auto hot = profile.GetHotCells(10);
+        ASSERT_EQUAL(hot.size(), 6u);
+        std::size_t evaluations = 0;
+        for (std::size_t i = 0; i < hot.size(); ++i) {
+            evaluations += hot[i].evaluations;
+            ASSERT(i == 0 || hot[i - 1].time >= hot[i].time);
+        }
+        ASSERT_EQUAL(evaluations, 10u);
+        ASSERT_EQUAL(profile.GetHotCells(2).size(), 2u);
+
+        const auto triggers = profile.GetTriggers(10);
+        ASSERT_EQUAL(triggers.size(), 2u);
+        ASSERT_EQUAL(triggers[0].pos, "A1"_pos);
+        ASSERT_EQUAL(triggers[0].cascades, 2u);
+        ASSERT_EQUAL(triggers[0].invalidated, 8u);
+        ASSERT_EQUAL(triggers[0].max_invalidated, 4u);
+        ASSERT_EQUAL(triggers[0].evaluated, 8u);
+        ASSERT_EQUAL(triggers[1].pos, "A2"_pos);
+        ASSERT_EQUAL(triggers[1].invalidated, 1u);
+
+        //     B1 -> C1 -> D1 -> F1,  -    
+        const auto path = sheet.GetCriticalPath();
+        ASSERT(path.cells == std::vector<Position>({ "B1"_pos, "C1"_pos, "D1"_pos, "F1"_pos }));
+        std::chrono::nanoseconds path_time{};
+        for (Position pos : path.cells) {
+            path_time += profile.GetMeanTime(pos);
+        }
+        ASSERT(path.time == path_time);
+        ASSERT(profile.GetMeanTime("A1"_pos) == std::chrono::nanoseconds(0));
+
+        sheet.StartProfiling();
+        ASSERT(sheet.GetProfile().GetTriggers(10).empty());
+        ASSERT(Sheet().GetCriticalPath().cells.empty());
+    }
+
+    void TestMemoryUsage() {
+        Sheet sheet;
+        ASSERT_EQUAL(sheet.GetMemoryUsage().GetTotal(), 0u);
+
+        sheet.SetCell("A1"_pos, "1");
+        const auto number = sheet.GetMemoryUsage();
+        ASSERT(number.cells > 0);
+        ASSERT_EQUAL(number.texts, 0u);
+
+        sheet.SetCell("A2"_pos, "text that does not fit into the string itself");
+        ASSERT(sheet.GetMemoryUsage().texts > 0);
+        ASSERT(sheet.GetMemoryUsage().cells > number.cells);
+
+        sheet.SetCell("B1"_pos, "=A1+A1*2+C1");
+        const auto formula = sheet.GetMemoryUsage();
+        ASSERT(formula.formulas > 0);
+        ASSERT(formula.dependencies > 0);
+        ASSERT_EQUAL(formula.values, sizeof(BoxedValue));
+
+        sheet.PublishValues();
+        const auto published = sheet.GetMemoryUsage();
+        ASSERT(published.values > formula.values);
+        //        ,     
+        const auto clone = sheet.Clone()->GetMemoryUsage();
+        ASSERT_EQUAL(clone.cells, published.cells);
+        ASSERT_EQUAL(clone.formulas, published.formulas);
+        ASSERT_EQUAL(clone.dependencies, published.dependencies);
+        ASSERT_EQUAL(clone.values, formula.values);
+
+        sheet.SetCell("B1"_pos, "plain");
+        ASSERT_EQUAL(sheet.GetMemoryUsage().formulas, 0u);
+        ASSERT_EQUAL(sheet.GetMemoryUsage().dependencies, 0u);
+        for (const char* pos : { "A1", "A2", "B1", "C1" }) {
+            sheet.ClearCell(Position::FromString(pos));
+        }
+        sheet.PublishValues();
+        ASSERT_EQUAL(sheet.GetMemoryUsage().cells, 0u);
+        ASSERT_EQUAL(sheet.GetMemoryUsage().values, 0u);
+
+        //      ,   ,  
+        WorkloadGenerator generator(7);
+        const Size size{ 30, 6 };
+        Sheet edited;
+        ApplyWorkload(edited, generator.RandomDag(size, 120, 0.5, 3));
+        ApplyWorkload(edited, generator.Edits(size, 1000));
+        std::stringstream tsv;
+        edited.PrintTexts(tsv);
+        Sheet rebuilt;
+        ApplyWorkload(rebuilt, ReadTsv(tsv));
+        ASSERT_EQUAL(edited.GetMemoryUsage().formulas, rebuilt.GetMemoryUsage().formulas);
+        ASSERT_EQUAL(edited.GetMemoryUsage().dependencies, rebuilt.GetMemoryUsage().dependencies);
+        ASSERT_EQUAL(edited.GetMemoryUsage().values, rebuilt.GetMemoryUsage().values);
+    }
+
     void TestCacheReevaluating() {
         auto sheet = CreateSheet();
         sheet->SetCell("A1"_pos, "1");
@@ -383,6 +1326,7 @@ int main() {
     RUN_TEST(tr, TestPositionAndStringConversion);
     RUN_TEST(tr, TestPositionToStringInvalid);
     RUN_TEST(tr, TestStringToPositionInvalid);
+    RUN_TEST(tr, TestPositionBufferConversion);
     RUN_TEST(tr, TestEmpty);
     RUN_TEST(tr, TestInvalidPosition);
     RUN_TEST(tr, TestSetCellPlainText);
@@ -399,6 +1343,29 @@ int main() {
     RUN_TEST(tr, TestCellReferences);
     RUN_TEST(tr, TestFormulaIncorrect);
     RUN_TEST(tr, TestCellCircularReferences);
+    RUN_TEST(tr, TestValueView);
+    RUN_TEST(tr, TestNumberCellText);
+    RUN_TEST(tr, TestNumberRecognition);
+    RUN_TEST(tr, TestDiamondDependencies);
+    RUN_TEST(tr, TestStringInterning);
+    RUN_TEST(tr, TestValueSnapshots);
+    RUN_TEST(tr, TestSheetClone);
+    RUN_TEST(tr, TestScenarioEvaluator);
+    RUN_TEST(tr, TestEarlyCutoff);
+    RUN_TEST(tr, TestDependencyEdgesRemoval);
+    RUN_TEST(tr, TestReferencedCellsOrder);
+    RUN_TEST(tr, TestFormulaConstantFolding);
+    RUN_TEST(tr, TestSharedSubexpressions);
+    RUN_TEST(tr, TestFormulaCellBinding);
+    RUN_TEST(tr, TestBoxedValue);
+    RUN_TEST(tr, TestColumnRuns);
+    RUN_TEST(tr, TestFormulaParserReuse);
+    RUN_TEST(tr, TestParallelParsing);
+    RUN_TEST(tr, TestWorkloadGenerator);
+    RUN_TEST(tr, TestTraceReplay);
+    RUN_TEST(tr, TestSheetMetrics);
+    RUN_TEST(tr, TestCellProfiler);
+    RUN_TEST(tr, TestMemoryUsage);
     //----------------------------------------
     RUN_TEST(tr, TestCacheReevaluating);
     return 0;
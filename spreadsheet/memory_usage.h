@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Оценки памяти структур листа: размеры объектов и их выделений в куче без
+// накладных расходов распределителя памяти
+namespace Memory {
+
+    // Текст строки в куче, 0, если он помещается в саму строку
+    inline std::size_t HeapSize(const std::string& str) {
+        return str.capacity() > std::string().capacity() ? str.capacity() + 1 : 0;
+    }
+
+    template <typename T>
+    std::size_t HeapSize(const std::vector<T>& vec) {
+        return vec.capacity() * sizeof(T);
+    }
+
+    // Элемент std::unordered_map или std::unordered_set с value_type T: узел со
+    // ссылкой на следующий и хешем и в среднем одна корзина таблицы
+    template <typename T>
+    inline constexpr std::size_t HASH_NODE_SIZE = sizeof(T) + 3 * sizeof(void*);
+
+    // Объект, созданный std::make_shared, вместе со счётчиками ссылок
+    template <typename T>
+    inline constexpr std::size_t SHARED_SIZE = sizeof(T) + 2 * sizeof(void*);
+
+    // Отдельный блок счётчиков std::shared_ptr, созданного из готового указателя
+    inline constexpr std::size_t SHARED_CONTROL_SIZE = 3 * sizeof(void*);
+
+} // namespace Memory
@@ -0,0 +1,21 @@
+#include "metrics.h"
+
+#include <ostream>
+
+namespace {
+	void WritePhase(std::ostream& out, const char* name, const SheetMetrics::Phase& phase) {
+		out << '"' << name << "\":{\"count\":" << phase.count << ",\"ns\":" << phase.time.count() << "},";
+	}
+} // namespace
+
+void SheetMetrics::WriteJson(std::ostream& out) const {
+	out << "{\"enabled\":" << (ENABLED ? "true" : "false") << ',';
+	WritePhase(out, "change", change);
+	WritePhase(out, "parse", parse);
+	WritePhase(out, "cycle_check", cycle_check);
+	WritePhase(out, "evaluate", evaluate);
+	WritePhase(out, "recalc", recalc);
+	out << "\"evaluations\":" << evaluations
+		<< ",\"invalidated\":" << invalidated
+		<< ",\"max_cascade_depth\":" << max_cascade_depth << '}';
+}
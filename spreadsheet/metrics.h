@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+
+// Счётчики и время этапов изменения листа собираются только в сборке с
+// -DSPREADSHEET_METRICS=1 (cmake -DSPREADSHEET_METRICS=ON). Без неё замеры
+// вырезаются при компиляции, а все значения SheetMetrics остаются нулевыми
+#ifndef SPREADSHEET_METRICS
+#define SPREADSHEET_METRICS 0
+#endif
+
+struct SheetMetrics {
+    static constexpr bool ENABLED = SPREADSHEET_METRICS != 0;
+
+    // Этап: сколько раз выполнялся и сколько времени занял в сумме
+    struct Phase {
+        std::size_t count = 0;
+        std::chrono::nanoseconds time{};
+    };
+
+    // SetCell, SetFormula и ClearCell целиком, включая этапы ниже
+    Phase change;
+    // Разбор формул, в SetCells - параллельный разбор всей пачки
+    Phase parse;
+    // Проверка циклических зависимостей новой формулы
+    Phase cycle_check;
+    // Первое вычисление новой формулы
+    Phase evaluate;
+    // Пересчёт ячеек, зависящих от изменённой
+    Phase recalc;
+
+    // Сколько раз вычислялись формулы, при записи и при пересчёте
+    std::size_t evaluations = 0;
+    // Сколько зависимых ячеек затронули изменения, вычисленных и пропущенных
+    std::size_t invalidated = 0;
+    // Наибольшая длина цепочки зависимостей, по которой прошёл пересчёт
+    std::size_t max_cascade_depth = 0;
+
+    // Одна строка JSON, время в наносекундах:
+    // {"enabled":true,"change":{"count":1,"ns":2},...,"max_cascade_depth":3}
+    void WriteJson(std::ostream& out) const;
+};
+
+// Добавляет к этапу время от создания до разрушения объекта
+class PhaseTimer {
+public:
+    explicit PhaseTimer(SheetMetrics::Phase& phase)
+        : phase_(phase) {
+        if constexpr (SheetMetrics::ENABLED) {
+            start_ = Clock::now();
+        }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    ~PhaseTimer() {
+        if constexpr (SheetMetrics::ENABLED) {
+            ++phase_.count;
+            phase_.time += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_);
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    SheetMetrics::Phase& phase_;
+    Clock::time_point start_;
+};
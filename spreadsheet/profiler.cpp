@@ -0,0 +1,66 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace {
+	// Первые n элементов values по убыванию ключа key, при равенстве - по позиции
+	template <typename T, typename Key>
+	std::vector<T> GetTop(const std::unordered_map<Position, T, CellImpl::PositionHash>& values, std::size_t n, Key key) {
+		std::vector<T> top;
+		top.reserve(values.size());
+		for (const auto& [pos, value] : values) {
+			top.push_back(value);
+		}
+		const auto greater = [&key](const T& lhs, const T& rhs) {
+			const auto lhs_key = key(lhs);
+			const auto rhs_key = key(rhs);
+			return lhs_key != rhs_key ? rhs_key < lhs_key : lhs.pos < rhs.pos;
+		};
+		n = std::min(n, top.size());
+		std::partial_sort(top.begin(), top.begin() + n, top.end(), greater);
+		top.resize(n);
+		return top;
+	}
+} // namespace
+
+void CellProfiler::AddEvaluation(Position pos, std::chrono::nanoseconds time) {
+	HotCell& cell = cells_[pos];
+	cell.pos = pos;
+	++cell.evaluations;
+	cell.time += time;
+}
+
+void CellProfiler::AddCascade(Position pos, std::size_t invalidated, std::size_t evaluated) {
+	Trigger& trigger = triggers_[pos];
+	trigger.pos = pos;
+	++trigger.cascades;
+	trigger.invalidated += invalidated;
+	trigger.max_invalidated = std::max(trigger.max_invalidated, invalidated);
+	trigger.evaluated += evaluated;
+}
+
+std::vector<CellProfiler::HotCell> CellProfiler::GetHotCells(std::size_t n) const {
+	return GetTop(cells_, n, [](const HotCell& cell) {
+		return std::make_tuple(cell.time, cell.evaluations);
+	});
+}
+
+std::vector<CellProfiler::Trigger> CellProfiler::GetTriggers(std::size_t n) const {
+	return GetTop(triggers_, n, [](const Trigger& trigger) {
+		return std::make_tuple(trigger.invalidated, trigger.evaluated);
+	});
+}
+
+std::chrono::nanoseconds CellProfiler::GetMeanTime(Position pos) const {
+	const auto it = cells_.find(pos);
+	if (it == cells_.end()) {
+		return std::chrono::nanoseconds(0);
+	}
+	return it->second.time / static_cast<std::chrono::nanoseconds::rep>(it->second.evaluations);
+}
+
+void CellProfiler::Clear() {
+	cells_.clear();
+	triggers_.clear();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "cell.h"
+#include "common.h"
+
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// Профиль пересчёта листа: во что обходятся вычисления каждой формулы и
+// изменения каких ячеек запускают самые большие волны пересчёта
+class CellProfiler {
+public:
+    // Вычисления формулы ячейки pos
+    struct HotCell {
+        Position pos;
+        std::size_t evaluations = 0;
+        std::chrono::nanoseconds time{};
+    };
+
+    // Пересчёты, вызванные изменениями ячейки pos
+    struct Trigger {
+        Position pos;
+        // Сколько раз изменение ячейки запускало пересчёт зависимых
+        std::size_t cascades = 0;
+        // Сколько зависимых ячеек затронули эти пересчёты в сумме и самый большой из них
+        std::size_t invalidated = 0;
+        std::size_t max_invalidated = 0;
+        // Сколько формул при этом вычислено заново
+        std::size_t evaluated = 0;
+    };
+
+    void AddEvaluation(Position pos, std::chrono::nanoseconds time);
+    void AddCascade(Position pos, std::size_t invalidated, std::size_t evaluated);
+
+    // До n самых дорогих формул по суммарному времени вычислений
+    std::vector<HotCell> GetHotCells(std::size_t n) const;
+    // До n ячеек, изменения которых затронули больше всего зависимых ячеек
+    std::vector<Trigger> GetTriggers(std::size_t n) const;
+    // Среднее время вычисления формулы ячейки, 0, если её вычисления не замерялись
+    std::chrono::nanoseconds GetMeanTime(Position pos) const;
+
+    void Clear();
+
+private:
+    std::unordered_map<Position, HotCell, CellImpl::PositionHash> cells_;
+    std::unordered_map<Position, Trigger, CellImpl::PositionHash> triggers_;
+};
@@ -0,0 +1,396 @@
+#include "scenario.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+	// Значение ячейки так, как его видит формула: пустой текст - ноль, непустой - ошибка
+	FormulaInterface::Value ToFormulaValue(CellInterface::ValueView value) {
+		if (std::holds_alternative<double>(value)) {
+			return std::get<double>(value);
+		}
+		if (std::holds_alternative<FormulaError>(value)) {
+			return std::get<FormulaError>(value);
+		}
+		if (std::get<std::string_view>(value).empty()) {
+			return 0.0;
+		}
+		return FormulaError(FormulaError::Category::Value);
+	}
+
+	CellInterface::Value ToCellValue(FormulaInterface::Value value) {
+		if (std::holds_alternative<double>(value)) {
+			return std::get<double>(value);
+		}
+		return std::get<FormulaError>(value);
+	}
+} // namespace
+
+ScenarioEvaluator::ScenarioEvaluator(const Sheet& sheet, const std::vector<Position>& inputs,
+	const std::vector<Position>& outputs) {
+	for (Position pos : inputs) {
+		if (!pos.IsValid()) {
+			throw InvalidPositionException("Invalid position!");
+		}
+	}
+	for (Position pos : outputs) {
+		if (!pos.IsValid()) {
+			throw InvalidPositionException("Invalid position!");
+		}
+	}
+
+	// Обход в глубину без рекурсии от выходных ячеек. Формула попадает в подграф,
+	// если от входных зависит хотя бы одна из формул, которые в ней используются.
+	// Её уровень на единицу больше наибольшего уровня этих формул, поэтому формулы
+	// одного уровня друг от друга не зависят
+	std::unordered_set<Position, CellImpl::PositionHash> visited(inputs.begin(), inputs.end());
+	std::unordered_map<Position, int, CellImpl::PositionHash> levels;
+	for (Position pos : inputs) {
+		levels.emplace(pos, 0);
+	}
+	struct Affected {
+		int level = 0;
+		Position pos;
+		const CellImpl::FormulaImpl* formula = nullptr;
+	};
+	std::vector<Affected> affected;
+	std::vector<std::pair<Position, bool>> to_visit;
+	for (Position pos : outputs) {
+		to_visit.push_back({ pos, false });
+	}
+
+	while (!to_visit.empty()) {
+		auto [current, refs_ready] = to_visit.back();
+		to_visit.pop_back();
+
+		const Cell* cell = sheet.PeekCell(current);
+		const auto formula = cell ? cell->GetFormula() : nullptr;
+		if (!refs_ready) {
+			if (!formula || !visited.insert(current).second) {
+				continue;
+			}
+			to_visit.push_back({ current, true });
+			for (Position ref : formula->GetReferencedCells()) {
+				to_visit.push_back({ ref, false });
+			}
+			continue;
+		}
+
+		int level = -1;
+		for (Position ref : formula->GetReferencedCells()) {
+			if (auto it = levels.find(ref); it != levels.end()) {
+				level = std::max(level, it->second);
+			}
+		}
+		if (level < 0) {
+			continue;
+		}
+		levels.emplace(current, level + 1);
+		affected.push_back({ level + 1, current, formula });
+	}
+
+	// Ячейки подграфа нумеруются по столбцам сверху вниз. Тогда соседние ячейки
+	// столбца получают соседние номера, и сдвигающаяся ссылка серии читает
+	// сплошной срез. Ячейка, не зависящая от входных, получает значение из листа
+	std::vector<Position> positions(inputs.begin(), inputs.end());
+	for (const Affected& cell : affected) {
+		positions.push_back(cell.pos);
+		const auto& refs = cell.formula->GetReferencedCells();
+		positions.insert(positions.end(), refs.begin(), refs.end());
+	}
+	auto by_column = [](Position lhs, Position rhs) {
+		return std::tie(lhs.col, lhs.row) < std::tie(rhs.col, rhs.row);
+	};
+	std::sort(positions.begin(), positions.end(), by_column);
+	positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+	std::unordered_map<Position, std::size_t, CellImpl::PositionHash> slots;
+	for (Position pos : positions) {
+		slots.emplace(pos, initial_slots_.size());
+		initial_slots_.push_back(ToFormulaValue(sheet.GetValueView(pos)));
+	}
+	for (Position pos : inputs) {
+		input_slots_.push_back(slots.at(pos));
+	}
+
+	// Формулы вычисляются по уровням, а внутри уровня подряд идущие формулы
+	// одного столбца собираются в серии
+	std::sort(affected.begin(), affected.end(), [](const Affected& lhs, const Affected& rhs) {
+		return std::tie(lhs.level, lhs.pos.col, lhs.pos.row) < std::tie(rhs.level, rhs.pos.col, rhs.pos.row);
+	});
+	for (std::size_t begin = 0; begin < affected.size();) {
+		ColumnRun run(affected[begin].pos, affected[begin].formula->GetProgram());
+		std::size_t end = begin + 1;
+		while (end < affected.size() && affected[end].level == affected[begin].level
+			&& run.TryAppend(affected[end].pos, affected[end].formula->GetProgram())) {
+			++end;
+		}
+
+		if (run.GetSize() >= ColumnRun::MIN_SIZE) {
+			Compile(run, slots);
+			vectorized_count_ += run.GetSize();
+		}
+		else {
+			for (std::size_t i = begin; i < end; ++i) {
+				Compile(ColumnRun(affected[i].pos, affected[i].formula->GetProgram()), slots);
+			}
+		}
+		begin = end;
+	}
+
+	for (Position pos : outputs) {
+		if (levels.count(pos)) {
+			outputs_.emplace_back(slots.at(pos));
+		}
+		else {
+			const Cell* cell = sheet.PeekCell(pos);
+			outputs_.emplace_back(cell ? cell->GetValue() : CellInterface::Value());
+		}
+	}
+}
+
+void ScenarioEvaluator::Compile(const ColumnRun& run,
+	const std::unordered_map<Position, std::size_t, CellImpl::PositionHash>& slots) {
+	CompiledFormula compiled;
+	compiled.begin = instructions_.size();
+	const auto& ops = run.GetProgram().ops;
+	for (std::size_t i = 0; i < ops.size(); ++i) {
+		Instruction instruction;
+		instruction.code = ops[i].code;
+		instruction.number = ops[i].number;
+		if (ops[i].code == FormulaProgram::Op::Code::Cell) {
+			instruction.slot = slots.at(ops[i].cell);
+			instruction.relative = run.IsRelative(i);
+		}
+		instructions_.push_back(instruction);
+	}
+	compiled.end = instructions_.size();
+	compiled.slot = slots.at(run.GetFirst());
+	compiled.size = run.GetSize();
+	formulas_.push_back(compiled);
+	formula_count_ += compiled.size;
+}
+
+std::size_t ScenarioEvaluator::GetFormulaCount() const {
+	return formula_count_;
+}
+
+std::size_t ScenarioEvaluator::GetVectorizedCount() const {
+	return vectorized_count_;
+}
+
+std::vector<ScenarioEvaluator::Results> ScenarioEvaluator::Evaluate(
+	const std::vector<std::vector<double>>& scenarios, unsigned threads) const {
+	for (const auto& scenario : scenarios) {
+		if (scenario.size() != input_slots_.size()) {
+			throw std::invalid_argument("Scenario size does not match the number of inputs");
+		}
+	}
+
+	std::vector<Results> results(scenarios.size());
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	// Наборы раздаются потокам пачками, чтобы потоки реже обращались к общему счётчику
+	constexpr std::size_t batch = 64;
+	std::atomic<std::size_t> next = 0;
+
+	auto worker = [&] {
+		std::vector<Slot> slots;
+		std::vector<double> stack;
+		std::vector<double> columns;
+		for (std::size_t begin = next.fetch_add(batch); begin < scenarios.size(); begin = next.fetch_add(batch)) {
+			const std::size_t end = std::min(begin + batch, scenarios.size());
+			for (std::size_t i = begin; i < end; ++i) {
+				EvaluateScenario(scenarios[i], slots, stack, columns, results[i]);
+			}
+		}
+	};
+
+	const std::size_t workers = std::min<std::size_t>(threads, (scenarios.size() + batch - 1) / batch);
+	std::vector<std::thread> pool;
+	for (std::size_t i = 1; i < workers; ++i) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : pool) {
+		thread.join();
+	}
+	return results;
+}
+
+void ScenarioEvaluator::EvaluateScenario(const std::vector<double>& inputs, std::vector<Slot>& slots,
+	std::vector<double>& stack, std::vector<double>& columns, Results& results) const {
+	slots = initial_slots_;
+	for (std::size_t i = 0; i < inputs.size(); ++i) {
+		slots[input_slots_[i]] = inputs[i];
+	}
+	for (const CompiledFormula& formula : formulas_) {
+		if (formula.size == 1) {
+			EvaluateFormula(formula, 0, slots, stack);
+		}
+		else {
+			EvaluateRun(formula, slots, columns, stack);
+		}
+	}
+
+	results.clear();
+	results.reserve(outputs_.size());
+	for (const auto& output : outputs_) {
+		if (std::holds_alternative<std::size_t>(output)) {
+			results.push_back(ToCellValue(slots[std::get<std::size_t>(output)].ToValue()));
+		}
+		else {
+			results.push_back(std::get<CellInterface::Value>(output));
+		}
+	}
+}
+
+void ScenarioEvaluator::EvaluateFormula(const CompiledFormula& formula, std::size_t lane,
+	std::vector<Slot>& slots, std::vector<double>& stack) const {
+	using Code = FormulaProgram::Op::Code;
+
+	const std::size_t result_slot = formula.slot + lane;
+	stack.clear();
+	for (std::size_t i = formula.begin; i < formula.end; ++i) {
+		const Instruction& instruction = instructions_[i];
+		if (instruction.code == Code::Number) {
+			stack.push_back(instruction.number);
+			continue;
+		}
+		if (instruction.code == Code::Cell) {
+			const Slot& value = slots[instruction.slot + (instruction.relative ? lane : 0)];
+			// Как и при вычислении на листе, первая встретившаяся ошибка становится значением формулы
+			if (value.IsError()) {
+				slots[result_slot] = value;
+				return;
+			}
+			stack.push_back(value.GetNumber());
+			continue;
+		}
+		if (instruction.code == Code::Negate) {
+			stack.back() = -stack.back();
+			continue;
+		}
+
+		const double rhs = stack.back();
+		stack.pop_back();
+		double& result = stack.back();
+		switch (instruction.code) {
+		case Code::Add:
+			result += rhs;
+			break;
+		case Code::Subtract:
+			result -= rhs;
+			break;
+		case Code::Multiply:
+			result *= rhs;
+			break;
+		case Code::Divide:
+			result /= rhs;
+			break;
+		default:
+			break;
+		}
+		if (!std::isfinite(result)) {
+			slots[result_slot] = FormulaError(FormulaError::Category::Div0);
+			return;
+		}
+	}
+	slots[result_slot] = stack.back();
+}
+
+void ScenarioEvaluator::EvaluateRun(const CompiledFormula& formula, std::vector<Slot>& slots,
+	std::vector<double>& columns, std::vector<double>& stack) const {
+	using Code = FormulaProgram::Op::Code;
+
+	// Серия вычисляется кусками, чтобы стек столбцов помещался в кэш
+	constexpr std::size_t chunk = 256;
+	columns.resize((formula.end - formula.begin) * chunk);
+	for (std::size_t first = 0; first < formula.size; first += chunk) {
+		const std::size_t count = std::min(chunk, formula.size - first);
+		// Столбцы стека: вершина - columns[(top - 1) * chunk]
+		std::size_t top = 0;
+		for (std::size_t i = formula.begin; i < formula.end; ++i) {
+			const Instruction& instruction = instructions_[i];
+			if (instruction.code == Code::Number) {
+				std::fill_n(&columns[top++ * chunk], count, instruction.number);
+				continue;
+			}
+			if (instruction.code == Code::Cell) {
+				// Ошибка упакована в NaN и дальше распространяется по вычислениям
+				// сама. Такие строки потом пересчитываются по одной
+				double* column = &columns[top++ * chunk];
+				if (instruction.relative) {
+					const Slot* values = &slots[instruction.slot + first];
+					for (std::size_t j = 0; j < count; ++j) {
+						column[j] = values[j].GetNumber();
+					}
+				}
+				else {
+					std::fill_n(column, count, slots[instruction.slot].GetNumber());
+				}
+				continue;
+			}
+			if (instruction.code == Code::Negate) {
+				double* column = &columns[(top - 1) * chunk];
+				for (std::size_t j = 0; j < count; ++j) {
+					column[j] = -column[j];
+				}
+				continue;
+			}
+
+			double* lhs = &columns[(top - 2) * chunk];
+			const double* rhs = &columns[(top - 1) * chunk];
+			--top;
+			// Циклы без ветвлений компилятор превращает в SIMD
+			switch (instruction.code) {
+			case Code::Add:
+				for (std::size_t j = 0; j < count; ++j) {
+					lhs[j] += rhs[j];
+				}
+				break;
+			case Code::Subtract:
+				for (std::size_t j = 0; j < count; ++j) {
+					lhs[j] -= rhs[j];
+				}
+				break;
+			case Code::Multiply:
+				for (std::size_t j = 0; j < count; ++j) {
+					lhs[j] *= rhs[j];
+				}
+				break;
+			case Code::Divide:
+				for (std::size_t j = 0; j < count; ++j) {
+					lhs[j] /= rhs[j];
+				}
+				break;
+			default:
+				break;
+			}
+			// Бесконечность дальше может пропасть (1 / inf == 0), а формула на
+			// листе уже здесь стала бы ошибкой. Поэтому она заменяется на NaN
+			for (std::size_t j = 0; j < count; ++j) {
+				lhs[j] = std::isfinite(lhs[j]) ? lhs[j] : std::numeric_limits<double>::quiet_NaN();
+			}
+		}
+
+		const double* result = columns.data();
+		for (std::size_t j = 0; j < count; ++j) {
+			if (std::isfinite(result[j])) {
+				slots[formula.slot + first + j] = result[j];
+			}
+			else {
+				EvaluateFormula(formula, first + j, slots, stack);
+			}
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "boxed_value.h"
+#include "column_runs.h"
+#include "common.h"
+#include "formula.h"
+#include "sheet.h"
+
+#include <cstddef>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+// Вычисляет выходные ячейки листа для множества наборов значений входных ячеек
+// (таблица подстановки), не изменяя лист. При создании выделяется минимальный
+// подграф ячеек, от которых зависят выходные, и формулы подграфа, зависящие от
+// входных ячеек, компилируются в программы стековой машины. Серии формул
+// одинаковой формы в столбце (см. ColumnRun) компилируются в одну программу и
+// вычисляются векторными циклами. Значения остальных ячеек подграфа берутся из
+// листа на момент создания, последующие изменения листа не учитываются
+class ScenarioEvaluator {
+public:
+    // Значения выходных ячеек для одного набора входных
+    using Results = std::vector<CellInterface::Value>;
+
+    // Бросает InvalidPositionException, если какая-либо позиция невалидна
+    ScenarioEvaluator(const Sheet& sheet, const std::vector<Position>& inputs, const std::vector<Position>& outputs);
+
+    // Для каждого набора значений входных ячеек (в порядке inputs) возвращает
+    // значения выходных ячеек (в порядке outputs). Наборы вычисляются параллельно
+    // в threads потоках, 0 - по числу ядер. Бросает std::invalid_argument, если
+    // размер какого-либо набора не совпадает с числом входных ячеек
+    std::vector<Results> Evaluate(const std::vector<std::vector<double>>& scenarios, unsigned threads = 0) const;
+
+    // Сколько формул пересчитывается для каждого набора
+    std::size_t GetFormulaCount() const;
+    // Сколько из них вычисляется сериями по столбцу
+    std::size_t GetVectorizedCount() const;
+
+private:
+    // Значение ячейки подграфа: число или ошибка
+    using Slot = BoxedValue;
+
+    struct Instruction {
+        FormulaProgram::Op::Code code = FormulaProgram::Op::Code::Number;
+        double number = 0.0;
+        // Номер ячейки подграфа для Code::Cell
+        std::size_t slot = 0;
+        // Ссылка сдвигается вместе со строкой серии
+        bool relative = false;
+    };
+
+    struct CompiledFormula {
+        // Инструкции формулы - полуинтервал [begin, end) в instructions_
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        // Куда записывается результат
+        std::size_t slot = 0;
+        // Формул в серии. Результат формулы из строки i серии записывается в
+        // ячейку slot + i, сдвигающиеся ссылки тоже смещаются на i
+        std::size_t size = 1;
+    };
+
+    // Значения ячеек подграфа до подстановки входных
+    std::vector<Slot> initial_slots_;
+    std::vector<std::size_t> input_slots_;
+    // Выходная ячейка либо вычисляется (номер ячейки подграфа), либо не зависит
+    // от входных и её значение известно заранее
+    std::vector<std::variant<std::size_t, CellInterface::Value>> outputs_;
+    std::vector<Instruction> instructions_;
+    // Формулы в порядке вычисления: каждая после тех, которые в ней используются
+    std::vector<CompiledFormula> formulas_;
+    std::size_t formula_count_ = 0;
+    std::size_t vectorized_count_ = 0;
+
+    void Compile(const ColumnRun& run, const std::unordered_map<Position, std::size_t, CellImpl::PositionHash>& slots);
+
+    void EvaluateScenario(const std::vector<double>& inputs, std::vector<Slot>& slots,
+        std::vector<double>& stack, std::vector<double>& columns, Results& results) const;
+    // Вычисляет формулу из строки lane серии
+    void EvaluateFormula(const CompiledFormula& formula, std::size_t lane, std::vector<Slot>& slots,
+        std::vector<double>& stack) const;
+    // Вычисляет всю серию. columns - место под стек столбцов
+    void EvaluateRun(const CompiledFormula& formula, std::vector<Slot>& slots, std::vector<double>& columns,
+        std::vector<double>& stack) const;
+};
@@ -2,25 +2,80 @@
 
 #include "cell.h"
 #include "common.h"
+#include "formula.h"
+#include "memory_usage.h"
 
 #include <algorithm>
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include <optional>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace std::literals;
 
+namespace {
+    //    ,      
+    CellInterface::Value CopyValue(CellInterface::ValueView value) {
+        return std::visit([](const auto& value) -> CellInterface::Value {
+            if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string_view>) {
+                return std::string(value);
+            }
+            else {
+                return value;
+            }
+        }, value);
+    }
+
+    bool IsFormula(std::string_view text) {
+        return text.size() > 1 && text[0] == FORMULA_SIGN;
+    }
+} // namespace
+
+Sheet::Sheet()
+    : strings_(std::make_shared<StringPool>()) {
+}
+
 Sheet::~Sheet() {    
 }
 
-bool Sheet::CheckCell(Position pos) const {
-    auto row = row_col_cell_.find(pos.row);
-    if (row != row_col_cell_.end() && row->second.find(pos.col) != row->second.end()) {
-        return true;
+std::unique_ptr<Sheet> Sheet::Clone() const {
+    auto clone = std::make_unique<Sheet>();
+    clone->strings_ = strings_;
+    clone->cells_ = cells_;
+    clone->printable_size_ = printable_size_;
+    clone->publish_all_ = true;
+    clone->formulas_memory_ = formulas_memory_;
+    clone->formula_count_ = formula_count_;
+    if (subexpressions_) {
+        clone->subexpressions_ = std::make_unique<SubexpressionPool>(*subexpressions_);
     }
-    else {
-        return false;
+    return clone;
+}
+
+void Sheet::StartTrace(std::ostream& out) {
+    trace_ = std::make_unique<TraceWriter>(out);
+}
+
+std::size_t Sheet::StopTrace() {
+    if (!trace_) {
+        return 0;
     }
+    const std::size_t count = trace_->GetCount();
+    trace_.reset();
+    return count;
+}
+
+void Sheet::Trace(WorkloadOp::Kind kind, Position pos, std::string_view text) const {
+    if (trace_ && !internal_reads_) {
+        trace_->Write(kind, pos, text);
+    }
+}
+
+bool Sheet::CheckCell(Position pos) const {
+    return cells_.Find(pos) != nullptr;
 }
 
 void Sheet::IsValidPos(Position pos) const {
@@ -29,87 +84,381 @@ void Sheet::IsValidPos(Position pos) const {
     }
 }
 
+Cell* Sheet::FindCell(Position pos) {
+    return cells_.FindForWrite(pos);
+}
+
+const Cell* Sheet::FindCell(Position pos) const {
+    return cells_.Find(pos);
+}
+
+Cell& Sheet::CreateCell(Position pos) {
+    Cell& cell = cells_.Create(pos);
+
+    //  -      ,   
+    if (pos.col > printable_size_.cols) {
+        printable_size_.cols = pos.col;
+    }
+    if (pos.row > printable_size_.rows) {
+        printable_size_.rows = pos.row;
+    }
+    return cell;
+}
+
+CellImpl::Content Sheet::CreateContent(Position pos, std::string_view text) {
+    // 
+    if (IsFormula(text)) {
+        //     -  FormulaException,   
+        std::unique_ptr<FormulaInterface> formula;
+        {
+            PhaseTimer timer(metrics_.parse);
+            formula = ParseFormula(std::string(text.substr(1)));
+        }
+        return CreateFormulaContent(pos, std::move(formula));
+    }
+    //   
+    return CellImpl::CreateTextContent(text, *strings_);
+}
+
+CellImpl::Content Sheet::CreateFormulaContent(Position pos, std::unique_ptr<FormulaInterface> formula) {
+    const auto& referenced_cells = formula->GetReferencedCells();
+    {
+        PhaseTimer timer(metrics_.cycle_check);
+        CheckCircular(pos, referenced_cells);
+    }
+
+    // ,    ,  
+    for (const Position& ref : referenced_cells) {
+        if (!CheckCell(ref)) {
+            CreateCell(ref);
+        }
+    }
+    return std::make_unique<CellImpl::FormulaImpl>(std::move(formula));
+}
+
+void Sheet::CheckCircular(Position self, const std::vector<Position>& positions) const {
+    std::unordered_set<Position, CellImpl::PositionHash> checked_positions;
+    std::vector<Position> to_check = positions;
+
+    while (!to_check.empty()) {
+        Position pos = to_check.back();
+        to_check.pop_back();
+
+        if (pos == self) {
+            throw CircularDependencyException("");
+        }
+        //    
+        if (!checked_positions.insert(pos).second) {
+            continue;
+        }
+        if (const Cell* cell = FindCell(pos)) {
+            if (const auto formula = cell->GetFormula()) {
+                const auto& referenced_cells = formula->GetReferencedCells();
+                to_check.insert(to_check.end(), referenced_cells.begin(), referenced_cells.end());
+            }
+        }
+    }
+}
+
 void Sheet::SetCell(Position pos, std::string text) {
     IsValidPos(pos);
-    
-    if (CheckCell(pos)) {
-        static_cast<Cell*>(GetCell(pos))->Set(text);        
+    Trace(WorkloadOp::Kind::Set, pos, text);
+    PhaseTimer timer(metrics_.change);
+
+    //     ,      
+    InstallContent(pos, CreateContent(pos, text));
+}
+
+void Sheet::SetFormula(Position pos, std::unique_ptr<FormulaInterface> formula) {
+    IsValidPos(pos);
+    if (!formula) {
+        throw FormulaException("Invalid formula");
+    }
+    if (trace_) {
+        Trace(WorkloadOp::Kind::Set, pos, FORMULA_SIGN + formula->GetExpression());
+    }
+    PhaseTimer timer(metrics_.change);
+    InstallContent(pos, CreateFormulaContent(pos, std::move(formula)));
+}
+
+void Sheet::SetCells(const std::vector<std::pair<Position, std::string>>& cells, unsigned threads) {
+    //  -          , 
+    //   ,    - 
+    std::vector<std::string> expressions;
+    for (const auto& [pos, text] : cells) {
+        if (IsFormula(text)) {
+            expressions.push_back(text.substr(1));
+        }
+    }
+    std::vector<std::unique_ptr<FormulaInterface>> formulas;
+    {
+        PhaseTimer timer(metrics_.parse);
+        formulas = ParseFormulas(expressions, threads);
     }
-    else {
-        auto new_cell_ptr = std::make_unique<Cell>(text, *this, pos);
-        row_col_cell_[pos.row][pos.col] = std::move(new_cell_ptr);
 
-        //  -      ,   
-        if (pos.col > printable_size_.cols) {
-            printable_size_.cols = pos.col;
+    auto formula = formulas.begin();
+    for (const auto& [pos, text] : cells) {
+        if (IsFormula(text)) {
+            SetFormula(pos, std::move(*formula++));
         }
-        if (pos.row > printable_size_.rows) {
-            printable_size_.rows = pos.row;
+        else {
+            SetCell(pos, text);
         }
-        rows_cols_numbers_[pos.row].insert(pos.col);
-    }    
+    }
 }
 
-const CellInterface* Sheet::GetCell(Position pos) const {
-    IsValidPos(pos);
-    
-    if (CheckCell(pos)) {
-        return row_col_cell_.at(pos.row).at(pos.col).get();
+void Sheet::InstallContent(Position pos, CellImpl::Content content) {
+    //   ,     - 
+    std::optional<CellInterface::Value> old_value;
+    if (cells_.GetReferring(pos)) {
+        old_value = CopyValue(GetValueView(pos));
     }
-    else {
-        return nullptr;
+
+    Cell* cell = FindCell(pos);
+    if (!cell) {
+        cell = &CreateCell(pos);
+    }
+    //   ,    
+    const auto old_content = cell->SetContent(std::move(content));
+    UpdateReferences(pos, CellImpl::GetReferencedCells(old_content), CellImpl::GetReferencedCells(cell->GetContent()));
+    UpdateShared(old_content, cell->GetFormula());
+    UpdateMemory(old_content, cell->GetFormula());
+    // ,     ,  
+    if (auto formula = cell->GetFormula()) {
+        PhaseTimer timer(metrics_.evaluate);
+        EvaluateFormula(pos, *formula);
+    }
+    MarkChanged(pos);
+
+    //   ,     
+    if (old_value) {
+        PropagateChange(pos, *old_value);
     }
 }
 
-CellInterface* Sheet::GetCell(Position pos) {
-    IsValidPos(pos);
+void Sheet::UpdateReferences(Position pos, const std::vector<Position>& old_references,
+    const std::vector<Position>& new_references) {
+    for (const Position& ref : old_references) {
+        if (!std::binary_search(new_references.begin(), new_references.end(), ref)) {
+            cells_.RemoveReferring(ref, pos);
+        }
+    }
+    for (const Position& ref : new_references) {
+        cells_.AddReferring(ref, pos);
+    }
+}
+
+void Sheet::PropagateChange(Position pos, const CellInterface::Value& old_value) {
+    PhaseTimer timer(metrics_.recalc);
+    //       ,   . 
+    //   order   ,    . 
+    //  ,     ,    
+    //  :  ,   ,   
+    // order  ,       
+    std::vector<Position> order;
+    std::unordered_set<Position, CellImpl::PositionHash> visited;
+    std::vector<std::pair<Position, bool>> to_visit{ { pos, false } };
 
-    if (CheckCell(pos)) {
-        return row_col_cell_[pos.row][pos.col].get();
+    while (!to_visit.empty()) {
+        auto [current, referring_ready] = to_visit.back();
+        to_visit.pop_back();
+        if (referring_ready) {
+            order.push_back(current);
+            continue;
+        }
+        //         
+        if (!visited.insert(current).second) {
+            continue;
+        }
+
+        to_visit.push_back({ current, true });
+        if (const auto referring = cells_.GetReferring(current)) {
+            for (const Position& referring_pos : *referring) {
+                if (visited.count(referring_pos) == 0) {
+                    to_visit.push_back({ referring_pos, false });
+                }
+            }
+        }
+    }
+    //   order    pos
+    order.pop_back();
+    if constexpr (SheetMetrics::ENABLED) {
+        metrics_.invalidated += order.size();
+    }
+#if SPREADSHEET_METRICS
+    //          pos  .
+    //      
+    std::unordered_map<Position, std::size_t, CellImpl::PositionHash> depths{ { pos, 0 } };
+#endif
+
+    std::unordered_set<Position, CellImpl::PositionHash> changed;
+    std::size_t evaluated = 0;
+    if (!(CopyValue(GetValueView(pos)) == old_value)) {
+        changed.insert(pos);
+    }
+
+    //        ,    .
+    //  ,         
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const Cell* cell = cells_.Find(*it);
+        auto formula = cell ? cell->GetFormula() : nullptr;
+        if (!formula) {
+            continue;
+        }
+        const auto& referenced_cells = formula->GetReferencedCells();
+#if SPREADSHEET_METRICS
+        std::size_t depth = 0;
+        for (const Position& ref : referenced_cells) {
+            if (const auto ref_depth = depths.find(ref); ref_depth != depths.end()) {
+                depth = std::max(depth, ref_depth->second + 1);
+            }
+        }
+        depths.emplace(*it, depth);
+        metrics_.max_cascade_depth = std::max(metrics_.max_cascade_depth, depth);
+#endif
+        if (std::none_of(referenced_cells.begin(), referenced_cells.end(),
+            [&changed](Position ref) { return changed.count(ref) > 0; })) {
+            ++recalc_stats_.skipped;
+            continue;
+        }
+
+        // ,    ,   , 
+        //         ,  
+        CellImpl::FormulaImpl& evaluated_formula = *FindCell(*it)->GetFormula();
+        const auto previous = evaluated_formula.GetValueView();
+        EvaluateFormula(*it, evaluated_formula);
+        ++evaluated;
+        if (!(evaluated_formula.GetValueView() == previous)) {
+            changed.insert(*it);
+            MarkChanged(*it);
+        }
+    }
+    if (profiling_) {
+        profile_.AddCascade(pos, order.size(), evaluated);
+    }
+}
+
+void Sheet::EvaluateFormula(Position pos, CellImpl::FormulaImpl& formula) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = profiling_ ? Clock::now() : Clock::time_point();
+
+    if (subexpressions_) {
+        internal_reads_ = true;
+        formula.Evaluate(*this, *subexpressions_);
+        internal_reads_ = false;
     }
     else {
-        return nullptr;
+        //   ,        
+        if (formula.GetLayoutVersion() != cells_.GetLayoutVersion()) {
+            formula.Bind(cells_.GetLayoutVersion(), [this](Position ref) {
+                return cells_.Find(ref);
+            });
+        }
+        formula.EvaluateBound();
+    }
+    ++recalc_stats_.evaluated;
+    if constexpr (SheetMetrics::ENABLED) {
+        ++metrics_.evaluations;
+    }
+    if (profiling_) {
+        profile_.AddEvaluation(pos, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start));
     }
 }
 
+void Sheet::UpdateShared(const CellImpl::Content& old_content, CellImpl::FormulaImpl* formula) {
+    if (!subexpressions_) {
+        return;
+    }
+    //  :    
+    subexpressions_->NextEpoch();
+    const auto old_formula = std::get_if<std::unique_ptr<CellImpl::FormulaImpl>>(&old_content);
+    if (old_formula) {
+        subexpressions_->Remove((*old_formula)->GetSharedRoot().value());
+    }
+    if (formula) {
+        formula->SetSharedRoot(subexpressions_->Add(formula->GetProgram()));
+    }
+}
+
+void Sheet::UpdateMemory(const CellImpl::Content& old_content, const CellImpl::FormulaImpl* formula) {
+    const auto old_formula = std::get_if<std::unique_ptr<CellImpl::FormulaImpl>>(&old_content);
+    if (old_formula) {
+        formulas_memory_ -= (*old_formula)->GetMemoryUsage();
+        --formula_count_;
+    }
+    if (formula) {
+        formulas_memory_ += formula->GetMemoryUsage();
+        ++formula_count_;
+    }
+}
+
+void Sheet::ShareSubexpressions() {
+    if (subexpressions_) {
+        return;
+    }
+    subexpressions_ = std::make_unique<SubexpressionPool>();
+    for (int tile_id : cells_.GetTileIds()) {
+        std::vector<Position> formulas;
+        for (const auto& [offset, cell] : cells_.FindTile(tile_id)->cells) {
+            if (cell.GetFormula()) {
+                formulas.push_back(Tiling::GetPosition(tile_id, offset));
+            }
+        }
+        for (Position pos : formulas) {
+            auto formula = FindCell(pos)->GetFormula();
+            formula->SetSharedRoot(subexpressions_->Add(formula->GetProgram()));
+        }
+    }
+}
+
+SubexpressionPool::Stats Sheet::GetSubexpressionStats() const {
+    return subexpressions_ ? subexpressions_->GetStats() : SubexpressionPool::Stats{};
+}
+
+const CellInterface* Sheet::GetCell(Position pos) const {
+    IsValidPos(pos);
+    Trace(WorkloadOp::Kind::Get, pos);
+    return FindCell(pos);
+}
+
+const Cell* Sheet::PeekCell(Position pos) const {
+    return cells_.Find(pos);
+}
+
+CellInterface* Sheet::GetCell(Position pos) {
+    IsValidPos(pos);
+    Trace(WorkloadOp::Kind::Get, pos);
+    //  CellInterface   ,    
+    return const_cast<Cell*>(cells_.Find(pos));
+}
+
 void Sheet::ClearCell(Position pos) {
     IsValidPos(pos);
+    Trace(WorkloadOp::Kind::Clear, pos);
+    PhaseTimer timer(metrics_.change);
 
-    if (CheckCell(pos)) {
-        row_col_cell_[pos.row].erase(pos.col);
-        rows_cols_numbers_[pos.row].erase(pos.col);
+    std::optional<CellInterface::Value> old_value;
+    if (cells_.GetReferring(pos)) {
+        old_value = CopyValue(GetValueView(pos));
+    }
+
+    if (const Cell* cell = cells_.Find(pos)) {
+        UpdateReferences(pos, CellImpl::GetReferencedCells(cell->GetContent()), {});
+        UpdateShared(cell->GetContent(), nullptr);
+        UpdateMemory(cell->GetContent(), nullptr);
+        MarkChanged(pos);
+        cells_.Erase(pos);
 
-        //       ,  
-        if (row_col_cell_[pos.row].empty()) {
-            row_col_cell_.erase(pos.row);
-            rows_cols_numbers_.erase(pos.row);                      
+        //         ,
+        //    .   ,  -1, -1
+        if (pos.row == printable_size_.rows || pos.col == printable_size_.cols) {
+            printable_size_ = cells_.GetLastPosition();
         }
-    }  
-    //  
-    if (rows_cols_numbers_.empty()) {
-        printable_size_ = { -1, -1 };        
     }
-    else {
-        //        
-        //      
-        if (pos.row == printable_size_.rows) {
-            printable_size_.rows = rows_cols_numbers_.rbegin()->first;
-        }
-        if (pos.col == printable_size_.cols) {
-            int max_col = 0;
-
-            //        
-            std::for_each(rows_cols_numbers_.begin(),
-                rows_cols_numbers_.end(),
-                [&max_col](const auto& row) {
-                    if (*row.second.rbegin() > max_col) {
-                        max_col = *row.second.rbegin();
-                    }
-                }
-            );
-            printable_size_.cols = max_col;
-        }
-    } 
+    // ,   ,    
+    if (old_value) {
+        PropagateChange(pos, *old_value);
+    }
 }
 
 Size Sheet::GetPrintableSize() const {
@@ -117,36 +466,215 @@ Size Sheet::GetPrintableSize() const {
 }
 
 struct value_output {
-    std::string operator()(const std::string& value) const {
-        return value;
+    std::ostream& output;
+
+    void operator()(std::string_view value) const {
+        output << value;
     }
 
-    std::string operator()(const double value) const {
-        std::stringstream temp;
-        temp << value;
-        return temp.str();
+    void operator()(const double value) const {
+        output << value;
     }
 
-    std::string operator()(const FormulaError& x) const {
-        return std::string(x.ToString());
+    void operator()(const FormulaError& x) const {
+        output << x.ToString();
     }
 };
 
+CellInterface::ValueView Sheet::GetValueView(Position pos) const {
+    IsValidPos(pos);
+
+    if (const Cell* cell = FindCell(pos)) {
+        return cell->GetValueView();
+    }
+    return std::string_view();
+}
+
 void Sheet::PrintValues(std::ostream& output) const {
-    auto get_value = [this](int x, int y) {
-        const auto value = GetCell(Position{ x, y })->GetValue();        
-        return std::visit(value_output(), value);
+    auto print_value = [this](std::ostream& output, Position pos) {
+        std::visit(value_output{ output }, GetValueView(pos));
     };
-    PrintSheet(output, get_value);
+    PrintSheet(output, print_value);
 }
 
 void Sheet::PrintTexts(std::ostream& output) const {
-    auto get_text = [this](int x, int y) {
-        return GetCell(Position{ x, y })->GetText();
+    auto print_text = [this](std::ostream& output, Position pos) {
+        output << FindCell(pos)->GetText();
     };
-    PrintSheet(output, get_text);
+    PrintSheet(output, print_text);
+}
+
+Sheet::RecalcStats Sheet::GetRecalcStats() const {
+    return recalc_stats_;
+}
+
+const SheetMetrics& Sheet::GetMetrics() const {
+    return metrics_;
+}
+
+void Sheet::ResetMetrics() {
+    metrics_ = SheetMetrics();
+}
+
+void Sheet::StartProfiling() {
+    profile_.Clear();
+    profiling_ = true;
+}
+
+void Sheet::StopProfiling() {
+    profiling_ = false;
+}
+
+const CellProfiler& Sheet::GetProfile() const {
+    return profile_;
+}
+
+Sheet::CriticalPath Sheet::GetCriticalPath() const {
+    //        ,   
+    // ,     
+    struct Chain {
+        std::size_t length = 0;
+        Position previous = Position::NONE;
+    };
+    std::unordered_map<Position, Chain, CellImpl::PositionHash> chains;
+
+    auto find_formula = [this](Position pos) {
+        const Cell* cell = FindCell(pos);
+        return cell ? cell->GetFormula() : nullptr;
+    };
+
+    Position last = Position::NONE;
+    for (int tile_id : cells_.GetTileIds()) {
+        for (const auto& [offset, cell] : cells_.FindTile(tile_id)->cells) {
+            if (!cell.GetFormula()) {
+                continue;
+            }
+            //     :      
+            std::vector<std::pair<Position, bool>> to_visit{ { Tiling::GetPosition(tile_id, offset), false } };
+            while (!to_visit.empty()) {
+                auto [current, references_ready] = to_visit.back();
+                to_visit.pop_back();
+                if (!references_ready) {
+                    if (chains.count(current) == 0) {
+                        to_visit.push_back({ current, true });
+                        for (const Position& ref : find_formula(current)->GetReferencedCells()) {
+                            if (find_formula(ref) && chains.count(ref) == 0) {
+                                to_visit.push_back({ ref, false });
+                            }
+                        }
+                    }
+                    continue;
+                }
+                if (chains.count(current) > 0) {
+                    continue;
+                }
+
+                Chain chain{ 1, Position::NONE };
+                for (const Position& ref : find_formula(current)->GetReferencedCells()) {
+                    if (const auto ref_chain = chains.find(ref); ref_chain != chains.end()
+                        && ref_chain->second.length + 1 > chain.length) {
+                        chain = { ref_chain->second.length + 1, ref };
+                    }
+                }
+                chains.emplace(current, chain);
+                //     ,   
+                const std::size_t last_length = last.IsValid() ? chains.at(last).length : 0;
+                if (chain.length > last_length || (chain.length == last_length && current < last)) {
+                    last = current;
+                }
+            }
+        }
+    }
+
+    CriticalPath path;
+    for (Position pos = last; pos.IsValid(); pos = chains.at(pos).previous) {
+        path.cells.push_back(pos);
+        path.time += profile_.GetMeanTime(pos);
+    }
+    std::reverse(path.cells.begin(), path.cells.end());
+    return path;
+}
+
+std::size_t Sheet::MemoryUsage::GetTotal() const {
+    return cells + texts + formulas + dependencies + values;
+}
+
+Sheet::MemoryUsage Sheet::GetMemoryUsage() const {
+    MemoryUsage usage;
+    usage.cells = cells_.GetCellsMemory();
+    usage.texts = strings_->GetMemoryUsage();
+    usage.formulas = formulas_memory_ + (subexpressions_ ? subexpressions_->GetMemoryUsage() : 0);
+    usage.dependencies = cells_.GetReferringMemory();
+    usage.values = formula_count_ * sizeof(BoxedValue) + snapshot_memory_;
+    return usage;
+}
+
+StringPool::Stats Sheet::GetStringPoolStats() const {
+    return strings_->GetStats();
+}
+
+void Sheet::MarkChanged(Position pos) {
+    changed_tiles_.insert(Tiling::GetTileId(pos));
+}
+
+std::shared_ptr<const ValueSnapshot::Tile> Sheet::BuildTile(int tile_id) const {
+    auto tile = std::make_shared<ValueSnapshot::Tile>();
+    const CellStorage::Tile* cells = cells_.FindTile(tile_id);
+    if (!cells) {
+        return tile;
+    }
+
+    for (const auto& [offset, cell] : cells->cells) {
+        auto value = cell.GetValue();
+        //      
+        if (std::holds_alternative<std::string>(value) && std::get<std::string>(value).empty()) {
+            continue;
+        }
+        tile->values.emplace_back(offset, std::move(value));
+    }
+    std::sort(tile->values.begin(), tile->values.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    return tile;
+}
+
+void Sheet::PublishValues() {
+    const ValueSnapshot& current = snapshots_.GetCurrent();
+    auto next = std::make_unique<ValueSnapshot>();
+    //      
+    next->tiles_ = current.tiles_;
+    if (publish_all_) {
+        const auto tile_ids = cells_.GetTileIds();
+        changed_tiles_.insert(tile_ids.begin(), tile_ids.end());
+        publish_all_ = false;
+    }
+    next->printable_size_ = GetPrintableSize();
+    next->version_ = current.version_ + 1;
+
+    for (int tile_id : changed_tiles_) {
+        if (const auto old_tile = current.tiles_.find(tile_id); old_tile != current.tiles_.end()) {
+            snapshot_memory_ -= old_tile->second->GetMemoryUsage();
+        }
+        auto tile = BuildTile(tile_id);
+        if (tile->values.empty()) {
+            next->tiles_.erase(tile_id);
+        }
+        else {
+            snapshot_memory_ += tile->GetMemoryUsage();
+            next->tiles_[tile_id] = std::move(tile);
+        }
+    }
+    changed_tiles_.clear();
+    snapshots_.Publish(std::move(next));
+}
+
+SnapshotPublisher::ReadGuard Sheet::ReadValues() const {
+    return snapshots_.Read();
 }
 
 std::unique_ptr<SheetInterface> CreateSheet() {
+    //     ,      
+    //      
+    WarmUpFormulaParser();
     return std::make_unique<Sheet>();
 }
\ No newline at end of file
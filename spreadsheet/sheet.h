@@ -1,19 +1,53 @@
 #pragma once
 
 #include "cell.h"
+#include "cell_storage.h"
 #include "common.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "snapshot.h"
+#include "string_pool.h"
+#include "subexpressions.h"
+#include "trace.h"
 
+#include <chrono>
 #include <functional>
-#include <unordered_map>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 class Sheet : public SheetInterface {
 public:
+    Sheet();
     ~Sheet();
 
+    //     O(1).       
+    //  ,        ,  N  
+    //         ,  
+    // .    ,       
+    //    .     
+    std::unique_ptr<Sheet> Clone() const;
+
     void SetCell(Position pos, std::string text) override;    
+    //    ,  ,  ParseFormulas.
+    //   ,   SetCell   .  nullptr, 
+    // ParseFormulas   ,  FormulaException
+    void SetFormula(Position pos, std::unique_ptr<FormulaInterface> formula);
+    //      ,   SetCell  ,  
+    //      threads , 0 -  
+    // .    ,   , 
+    void SetCells(const std::vector<std::pair<Position, std::string>>& cells, unsigned threads = 0);
 
     const CellInterface* GetCell(Position pos) const override;
     CellInterface* GetCell(Position pos) override;
+    //     .    -  
+    CellInterface::ValueView GetValueView(Position pos) const;
+    //   nullptr   .    GetCell, 
+    //    ,    ,    
+    const Cell* PeekCell(Position pos) const;
 
     void ClearCell(Position pos) override;
 
@@ -22,19 +56,160 @@ public:
     void PrintValues(std::ostream& output) const override;
     void PrintTexts(std::ostream& output) const override;
 
+    //    :        
+    StringPool::Stats GetStringPoolStats() const;
+
+    //       
+    struct MemoryUsage {
+        //    ,    
+        std::size_t cells = 0;
+        //     .       
+        std::size_t texts = 0;
+        // :  , ,      ,  
+        std::size_t formulas = 0;
+        //  :     ,   
+        std::size_t dependencies = 0;
+        //        
+        std::size_t values = 0;
+
+        std::size_t GetTotal() const;
+    };
+
+    //      ,   
+    // O(1)       . ,  
+    //  ,    
+    MemoryUsage GetMemoryUsage() const;
+
+    struct RecalcStats {
+        //    
+        std::size_t evaluated = 0;
+        //     ,   
+        // ,    ,  
+        std::size_t skipped = 0;
+    };
+
+    RecalcStats GetRecalcStats() const;
+
+    //          ResetMetrics.
+    //      SPREADSHEET_METRICS, . metrics.h
+    const SheetMetrics& GetMetrics() const;
+    void ResetMetrics();
+
+    //      :   
+    //          .
+    //        
+    void StartProfiling();
+    //  ,    
+    void StopProfiling();
+    const CellProfiler& GetProfile() const;
+
+    struct CriticalPath {
+        //    :   
+        std::vector<Position> cells;
+        //        
+        std::chrono::nanoseconds time{};
+    };
+
+    //     ,    
+    // .     , 
+    //           
+    CriticalPath GetCriticalPath() const;
+
+    //       :  
+    //              
+    //   .   .    Clone()
+    //   
+    void ShareSubexpressions();
+    //   , ,    
+    SubexpressionPool::Stats GetSubexpressionStats() const;
+
+    //         .
+    //  ,   ,    
+    void PublishValues();
+    //    .    
+    //     ,  
+    SnapshotPublisher::ReadGuard ReadValues() const;
+
+    //    out  SetCell, ClearCell  GetCell  
+    //      (trace.h),  
+    // spreadsheet_replay. SetFormula  SetCells   SetCell 
+    //  .        .
+    //   StopTrace   ,    out
+    //   .     
+    void StartTrace(std::ostream& out);
+    //       .    
+    std::size_t StopTrace();
+
     
 private:
-    std::unordered_map<int, std::unordered_map<int, std::unique_ptr<Cell>>> row_col_cell_;
+    //     ,     
+    std::shared_ptr<StringPool> strings_;
+
+    //       ,    
+    CellStorage cells_;
     // -1, -1    (       0, 0)
     Size printable_size_{-1, -1};
 
-    //             
-    std::map<int, std::set<int>> rows_cols_numbers_;    
+    // ,        
+    std::unordered_set<int> changed_tiles_;
+    //      :   
+    bool publish_all_ = false;
+
+    RecalcStats recalc_stats_;
+    SheetMetrics metrics_;
+    CellProfiler profile_;
+    bool profiling_ = false;
+    SnapshotPublisher snapshots_;
+    std::unique_ptr<SubexpressionPool> subexpressions_;
+    //     ,       
+    std::size_t formulas_memory_ = 0;
+    std::size_t formula_count_ = 0;
+    std::size_t snapshot_memory_ = 0;
+    //  , nullptr,   
+    std::unique_ptr<TraceWriter> trace_;
+    //      GetCell,      
+    bool internal_reads_ = false;
 
     //    
     bool CheckCell(Position pos) const;
     //    
     void IsValidPos(Position pos) const;
+    //    ,   
+    void Trace(WorkloadOp::Kind kind, Position pos, std::string_view text = {}) const;
+    //    nullptr,   .  
+    //      ,     
+    Cell* FindCell(Position pos);
+    const Cell* FindCell(Position pos) const;
+    //       
+    Cell& CreateCell(Position pos);
+    //     .    
+    //     ,    
+    CellImpl::Content CreateContent(Position pos, std::string_view text);
+    //        ,    
+    CellImpl::Content CreateFormulaContent(Position pos, std::unique_ptr<FormulaInterface> formula);
+    //    pos      
+    void InstallContent(Position pos, CellImpl::Content content);
+    //  CircularDependencyException,   self   positions
+    void CheckCircular(Position self, const std::vector<Position>& positions) const;
+    //    pos   :    
+    // old_references    new_references.  
+    void UpdateReferences(Position pos, const std::vector<Position>& old_references,
+        const std::vector<Position>& new_references);
+    //  ,      ,  
+    //    old_value.     
+    //        -   
+    void PropagateChange(Position pos, const CellInterface::Value& old_value);
+    //     ,   ,  
+    //    . pos -  
+    void EvaluateFormula(Position pos, CellImpl::FormulaImpl& formula);
+    //            
+    void UpdateShared(const CellImpl::Content& old_content, CellImpl::FormulaImpl* formula);
+    //          
+    void UpdateMemory(const CellImpl::Content& old_content, const CellImpl::FormulaImpl* formula);
+    // ,          
+    void MarkChanged(Position pos);
+    //      
+    std::shared_ptr<const ValueSnapshot::Tile> BuildTile(int tile_id) const;
     //   
     template <typename Func>
     void PrintSheet(std::ostream& output, Func& f) const;
@@ -46,7 +221,7 @@ void Sheet::PrintSheet(std::ostream& output, Func& f) const {
     for (int y = 0; y <= printable_size_.rows; ++y) {
         for (int x = 0; x <= printable_size_.cols; ++x) {
             if (CheckCell({ y,x })) {
-                output << f(y, x);
+                f(output, Position{ y, x });
             }
             if (!(x == printable_size_.cols)) {
                 output << '\t';
@@ -0,0 +1,130 @@
+#include "snapshot.h"
+
+#include "memory_usage.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+
+std::size_t ValueSnapshot::Tile::GetMemoryUsage() const {
+	std::size_t size = Memory::SHARED_SIZE<Tile> + Memory::HeapSize(values)
+		+ Memory::HASH_NODE_SIZE<std::pair<const int, std::shared_ptr<const Tile>>>;
+	for (const auto& [offset, value] : values) {
+		if (const auto text = std::get_if<std::string>(&value)) {
+			size += Memory::HeapSize(*text);
+		}
+	}
+	return size;
+}
+
+CellInterface::ValueView ValueSnapshot::GetValue(Position pos) const {
+	auto tile = tiles_.find(Tiling::GetTileId(pos));
+	if (tile == tiles_.end()) {
+		return std::string_view();
+	}
+
+	const auto& values = tile->second->values;
+	const int offset = Tiling::GetOffset(pos);
+	auto value = std::lower_bound(values.begin(), values.end(), offset,
+		[](const auto& item, int offset) {
+			return item.first < offset;
+		});
+	if (value == values.end() || value->first != offset) {
+		return std::string_view();
+	}
+
+	return std::visit([](const auto& value) -> CellInterface::ValueView {
+		return value;
+	}, value->second);
+}
+
+Size ValueSnapshot::GetPrintableSize() const {
+	return printable_size_;
+}
+
+std::uint64_t ValueSnapshot::GetVersion() const {
+	return version_;
+}
+
+// ----------------------------- SnapshotPublisher -----------------------------
+
+SnapshotPublisher::ReadGuard::ReadGuard(std::atomic<std::uint64_t>* slot, const ValueSnapshot* snapshot)
+	: slot_(slot), snapshot_(snapshot) {
+}
+
+SnapshotPublisher::ReadGuard::ReadGuard(ReadGuard&& other) noexcept
+	: slot_(std::exchange(other.slot_, nullptr)), snapshot_(other.snapshot_) {
+}
+
+SnapshotPublisher::ReadGuard::~ReadGuard() {
+	if (slot_) {
+		slot_->store(0);
+	}
+}
+
+const ValueSnapshot& SnapshotPublisher::ReadGuard::operator*() const {
+	return *snapshot_;
+}
+
+const ValueSnapshot* SnapshotPublisher::ReadGuard::operator->() const {
+	return snapshot_;
+}
+
+SnapshotPublisher::SnapshotPublisher()
+	: current_(new ValueSnapshot()) {
+}
+
+SnapshotPublisher::~SnapshotPublisher() {
+	delete current_.load();
+	for (const auto& [epoch, snapshot] : retired_) {
+		delete snapshot;
+	}
+}
+
+SnapshotPublisher::ReadGuard SnapshotPublisher::Read() const {
+	// Каждый поток начинает поиск свободного слота со своего, так слоты почти не делятся
+	thread_local const std::size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+	for (std::size_t attempt = 0;; ++attempt) {
+		auto& slot = readers_[(hint + attempt) % MAX_READERS].epoch;
+		std::uint64_t free_slot = 0;
+		// Сначала объявляем эпоху, и только потом читаем снимок: писатель, увидевший
+		// эту эпоху, не удалит снимок, который мы можем прочитать
+		if (slot.compare_exchange_strong(free_slot, epoch_.load())) {
+			return ReadGuard(&slot, current_.load());
+		}
+		if (attempt % MAX_READERS == MAX_READERS - 1) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void SnapshotPublisher::Publish(std::unique_ptr<const ValueSnapshot> snapshot) {
+	const ValueSnapshot* previous = current_.exchange(snapshot.release());
+	// Читатели, объявившие новую эпоху, гарантированно видят новый снимок
+	retired_.push_back({ epoch_.fetch_add(1) + 1, previous });
+	Reclaim();
+}
+
+const ValueSnapshot& SnapshotPublisher::GetCurrent() const {
+	return *current_.load();
+}
+
+void SnapshotPublisher::Reclaim() {
+	std::uint64_t min_epoch = std::numeric_limits<std::uint64_t>::max();
+	for (const auto& reader : readers_) {
+		const std::uint64_t epoch = reader.epoch.load();
+		if (epoch != 0) {
+			min_epoch = std::min(min_epoch, epoch);
+		}
+	}
+
+	auto still_read = std::partition(retired_.begin(), retired_.end(), [min_epoch](const auto& retired) {
+		return retired.first > min_epoch;
+	});
+	for (auto it = still_read; it != retired_.end(); ++it) {
+		delete it->second;
+	}
+	retired_.erase(still_read, retired_.end());
+}
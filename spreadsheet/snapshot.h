@@ -0,0 +1,97 @@
+#pragma once
+
+#include "common.h"
+#include "tiling.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Неизменяемый снимок вычисленных значений листа. Следующий снимок разделяет
+// с предыдущим все тайлы, в которых ничего не менялось
+class ValueSnapshot {
+public:
+    struct Tile {
+        // Значения ячеек тайла, отсортированные по смещению ячейки внутри тайла
+        std::vector<std::pair<int, CellInterface::Value>> values;
+
+        // Память тайла вместе с текстами значений и его элементом в снимке
+        std::size_t GetMemoryUsage() const;
+    };
+
+    // Значение ячейки на момент публикации снимка. Для отсутствующей ячейки -
+    // пустая строка. Текст валиден, пока жив снимок
+    CellInterface::ValueView GetValue(Position pos) const;
+    Size GetPrintableSize() const;
+    // Номер снимка, увеличивается при каждой публикации
+    std::uint64_t GetVersion() const;
+
+private:
+    friend class Sheet;
+
+    std::unordered_map<int, std::shared_ptr<const Tile>> tiles_;
+    Size printable_size_;
+    std::uint64_t version_ = 0;
+};
+
+// Публикует снимки значений для читателей из других потоков без блокировок.
+// Писатель (один поток) атомарно подменяет текущий снимок, а старые снимки
+// удаляет только тогда, когда их гарантированно никто не читает
+// (epoch-based reclamation)
+class SnapshotPublisher {
+public:
+    // Одновременно читать снимки могут не более MAX_READERS потоков, остальные ждут
+    static constexpr std::size_t MAX_READERS = 128;
+
+    // Пока объект жив, снимок, на который он указывает, не удаляется
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard();
+
+        const ValueSnapshot& operator*() const;
+        const ValueSnapshot* operator->() const;
+
+    private:
+        friend class SnapshotPublisher;
+        ReadGuard(std::atomic<std::uint64_t>* slot, const ValueSnapshot* snapshot);
+
+        std::atomic<std::uint64_t>* slot_;
+        const ValueSnapshot* snapshot_;
+    };
+
+    SnapshotPublisher();
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+    // К моменту разрушения читателей быть не должно
+    ~SnapshotPublisher();
+
+    // Может вызываться из любого потока
+    ReadGuard Read() const;
+
+    // Вызывается только потоком-писателем
+    void Publish(std::unique_ptr<const ValueSnapshot> snapshot);
+    // Последний опубликованный снимок. Вызывается только потоком-писателем
+    const ValueSnapshot& GetCurrent() const;
+
+private:
+    // Слот читателя хранит эпоху, в которую он начал чтение, 0 - слот свободен.
+    // Слоты выровнены по кэш-линии, чтобы читатели не мешали друг другу
+    struct alignas(64) ReaderSlot {
+        std::atomic<std::uint64_t> epoch{ 0 };
+    };
+
+    mutable std::array<ReaderSlot, MAX_READERS> readers_;
+    std::atomic<const ValueSnapshot*> current_{ nullptr };
+    std::atomic<std::uint64_t> epoch_{ 1 };
+    // Снимки, заменённые новыми, и эпоха, начиная с которой их не может прочитать новый читатель
+    std::vector<std::pair<std::uint64_t, const ValueSnapshot*>> retired_;
+
+    // Удаляет снимки, которые не читает ни один активный читатель
+    void Reclaim();
+};
@@ -0,0 +1,90 @@
+#include "string_pool.h"
+
+#include "memory_usage.h"
+
+#include <utility>
+
+StringPool::Handle::Handle(Entry* entry)
+	: entry_(entry) {
+	++entry_->refs;
+	++entry_->pool->total_refs_;
+}
+
+StringPool::Handle::Handle(const Handle& other)
+	: entry_(other.entry_) {
+	if (entry_) {
+		++entry_->refs;
+		++entry_->pool->total_refs_;
+	}
+}
+
+StringPool::Handle::Handle(Handle&& other) noexcept
+	: entry_(std::exchange(other.entry_, nullptr)) {
+}
+
+StringPool::Handle& StringPool::Handle::operator=(Handle other) noexcept {
+	std::swap(entry_, other.entry_);
+	return *this;
+}
+
+StringPool::Handle::~Handle() {
+	if (!entry_) {
+		return;
+	}
+	--entry_->pool->total_refs_;
+	if (--entry_->refs == 0) {
+		entry_->pool->Release(entry_);
+	}
+}
+
+std::string_view StringPool::Handle::Get() const {
+	return entry_ ? std::string_view(entry_->text) : std::string_view();
+}
+
+bool StringPool::Handle::operator==(const Handle& rhs) const {
+	return entry_ == rhs.entry_;
+}
+
+bool StringPool::Handle::operator!=(const Handle& rhs) const {
+	return !(*this == rhs);
+}
+
+StringPool::Handle StringPool::Add(std::string_view text) {
+	// Такой текст уже есть в пуле
+	if (auto it = index_.find(text); it != index_.end()) {
+		return Handle(it->second);
+	}
+
+	Entry* entry = nullptr;
+	// Переиспользуем освободившиеся записи
+	if (!free_entries_.empty()) {
+		entry = free_entries_.back();
+		free_entries_.pop_back();
+	}
+	else {
+		entry = &entries_.emplace_back();
+		entry->pool = this;
+	}
+	entry->text = text;
+	text_bytes_ += Memory::HeapSize(entry->text);
+	index_.emplace(entry->text, entry);
+	return Handle(entry);
+}
+
+StringPool::Stats StringPool::GetStats() const {
+	return { index_.size(), total_refs_ };
+}
+
+std::size_t StringPool::GetMemoryUsage() const {
+	return entries_.size() * sizeof(Entry) + text_bytes_
+		+ index_.size() * Memory::HASH_NODE_SIZE<decltype(index_)::value_type>
+		+ Memory::HeapSize(free_entries_);
+}
+
+void StringPool::Release(Entry* entry) {
+	index_.erase(entry->text);
+	text_bytes_ -= Memory::HeapSize(entry->text);
+	entry->text.clear();
+	entry->text.shrink_to_fit();
+	free_entries_.push_back(entry);
+}
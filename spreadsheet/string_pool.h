@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Пул текстов ячеек листа. Ячейка хранит не саму строку, а дескриптор на запись
+// пула размером в один указатель. Одинаковые тексты хранятся в пуле один раз,
+// поэтому их можно сравнивать по дескрипторам. Запись освобождается, когда на
+// неё не остаётся дескрипторов
+class StringPool {
+    struct Entry {
+        std::string text;
+        std::size_t refs = 0;
+        StringPool* pool = nullptr;
+    };
+
+public:
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(const Handle& other);
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle other) noexcept;
+        ~Handle();
+
+        std::string_view Get() const;
+
+        // Дескрипторы равны тогда и только тогда, когда равны их тексты
+        bool operator==(const Handle& rhs) const;
+        bool operator!=(const Handle& rhs) const;
+
+    private:
+        friend class StringPool;
+        explicit Handle(Entry* entry);
+
+        Entry* entry_ = nullptr;
+    };
+
+    struct Stats {
+        // Сколько различных строк хранится в пуле
+        std::size_t unique = 0;
+        // Сколько дескрипторов ссылается на строки пула
+        std::size_t total = 0;
+    };
+
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    Handle Add(std::string_view text);
+
+    Stats GetStats() const;
+    // Память записей, их текстов и индекса. Считается за O(1)
+    std::size_t GetMemoryUsage() const;
+
+private:
+    // Записи не перемещаются в памяти, поэтому дескрипторы и string_view на текст
+    // остаются валидными
+    std::deque<Entry> entries_;
+    std::vector<Entry*> free_entries_;
+    // Ключи указывают на текст записей
+    std::unordered_map<std::string_view, Entry*> index_;
+    std::size_t total_refs_ = 0;
+    // Сколько памяти в куче занимают тексты записей
+    std::size_t text_bytes_ = 0;
+
+    void Release(Entry* entry);
+};
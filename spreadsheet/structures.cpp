@@ -1,7 +1,8 @@
 #include "common.h"
 
-#include <cctype>
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <iterator>
 
 FormulaError::FormulaError(Category category)
 	: category_(category) {
@@ -29,17 +30,18 @@ std::string_view FormulaError::ToString() const {
 }
 
 const int LETTERS = 26;
-const int MAX_POSITION_LENGTH = 8;
-const int MAX_POS_LETTER_COUNT = 3;
 
 const Position Position::NONE = {-1, -1};
 
+static_assert(Position::FromString("C137").row == 136 && Position::FromString("C137").col == 2);
+
 bool Position::operator==(const Position rhs) const {
 	return (this->col == rhs.col) && (this->row == rhs.row);
 }
 
 bool Position::operator<(const Position rhs) const {
-	return (this->col < rhs.col) || (this->row < rhs.row);
+	// Построчный порядок: сначала по строке, затем по столбцу
+	return (this->row < rhs.row) || (this->row == rhs.row && this->col < rhs.col);
 }
 
 bool Position::IsValid() const {
@@ -47,68 +49,26 @@ bool Position::IsValid() const {
 }
 
 std::string Position::ToString() const {
+	Buffer buffer;
+	return std::string(ToString(buffer));
+}
+
+std::string_view Position::ToString(Buffer& buffer) const {
 	if (!IsValid()) {
-		return "";
+		return {};
 	}
-	std::string result;
 	// Так как в программе нумерация с нуля, а у пользователя с единицы, прибавляем 1 к номерам столбца и строки
-	// Номер столбца	
-	int temp_col = col + 1;
-
-	while (temp_col > 0) {		
-		int index = (temp_col - 1) % 26;
-		result = char(index + 'A') + std::move(result);
-		temp_col = (temp_col - 1) / 26;
+	// Номер столбца: буквы получаются от младшей к старшей, поэтому пишем их в конец временного массива
+	char letters[MAX_POS_LETTER_COUNT];
+	char* letters_begin = std::end(letters);
+	for (int temp_col = col + 1; temp_col > 0; temp_col = (temp_col - 1) / LETTERS) {
+		*--letters_begin = static_cast<char>((temp_col - 1) % LETTERS + 'A');
 	}
+	char* end = std::copy(letters_begin, std::end(letters), buffer.data());
 	// Номер строки
-	result += std::to_string(row + 1);
+	end = std::to_chars(end, buffer.data() + buffer.size(), row + 1).ptr;
 
-	return result;
-}
-
-int ColPosStringToInt(std::string_view str) {
-	int result = 0;
-
-	for (const char& c : str)
-	{
-		result *= 26;
-		result += c - 'A' + 1;
-	}
-	
-	return result;
-}
-
-Position Position::FromString(std::string_view str) {
-	if (str.length() > MAX_POSITION_LENGTH || str.empty()) {
-		return Position::NONE;
-	}
-	
-	std::string col_str, row_string;
-
-	size_t str_size = str.size();
-	bool char_passed = false;
-	for (size_t char_num = 0; char_num < str_size; ++char_num) {
-		// Если это не цифра или буква(заглавная), значит позиция невалидна
-		if (!std::isalnum(str[char_num]) || std::islower(str[char_num])) {
-			return Position::NONE;
-		}
-		else if (std::isalpha(str[char_num]) && std::isupper(str[char_num])) {
-			if (char_passed) {
-				return Position::NONE;
-			}
-			col_str += str[char_num];
-		}
-		else {
-			char_passed = true;
-			row_string += str[char_num];
-		}
-	}
-
-	if (col_str.empty() || row_string.empty()) {
-		return Position::NONE;
-	}
-	// Аналогично, необходимо вычесть 1 т.к. нумерация в системе начинается с нуля, а у пользователя с 1
-	return { std::stoi(row_string) - 1, ColPosStringToInt(col_str) - 1 };
+	return std::string_view(buffer.data(), end - buffer.data());
 }
 
 bool Size::operator==(Size rhs) const {
@@ -0,0 +1,221 @@
+#include "subexpressions.h"
+
+#include "cell.h"
+#include "memory_usage.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+	std::uint64_t ToBits(double value) {
+		std::uint64_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	double FromBits(std::uint64_t bits) {
+		double value = 0.0;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// Значение ячейки так, как его видит формула, см. CellExpr::Evaluate
+	double GetCellNumber(const SheetInterface& sheet, Position pos) {
+		const CellInterface* cell = sheet.GetCell(pos);
+		if (!cell) {
+			return 0.0;
+		}
+		const auto value = cell->GetValueView();
+		if (std::holds_alternative<FormulaError>(value)) {
+			throw std::get<FormulaError>(value);
+		}
+		if (std::holds_alternative<std::string_view>(value)) {
+			if (std::get<std::string_view>(value).empty()) {
+				return 0.0;
+			}
+			throw FormulaError(FormulaError::Category::Value);
+		}
+		return std::get<double>(value);
+	}
+} // namespace
+
+bool SubexpressionPool::Key::operator==(const Key& other) const {
+	return code == other.code && number == other.number && cell == other.cell
+		&& lhs == other.lhs && rhs == other.rhs;
+}
+
+std::size_t SubexpressionPool::KeyHash::operator()(const Key& key) const {
+	std::size_t res = 0;
+	CellImpl::hash_combine(res, static_cast<int>(key.code));
+	CellImpl::hash_combine(res, key.number);
+	CellImpl::hash_combine(res, CellImpl::PositionHash()(key.cell));
+	CellImpl::hash_combine(res, key.lhs);
+	CellImpl::hash_combine(res, key.rhs);
+	return res;
+}
+
+SubexpressionPool::NodeId SubexpressionPool::Add(const FormulaProgram& program) {
+	using Code = FormulaProgram::Op::Code;
+
+	// Программа в обратной польской записи: операнды узла уже на стеке
+	std::vector<NodeId> stack;
+	for (const auto& op : program.ops) {
+		Key key;
+		key.code = op.code;
+		switch (op.code) {
+		case Code::Number:
+			key.number = ToBits(op.number);
+			break;
+		case Code::Cell:
+			key.cell = op.cell;
+			break;
+		case Code::Negate:
+			key.lhs = stack.back();
+			stack.pop_back();
+			break;
+		default:
+			key.rhs = stack.back();
+			stack.pop_back();
+			key.lhs = stack.back();
+			stack.pop_back();
+			break;
+		}
+		stack.push_back(Intern(key));
+	}
+	return stack.back();
+}
+
+SubexpressionPool::NodeId SubexpressionPool::Intern(const Key& key) {
+	if (auto it = ids_.find(key); it != ids_.end()) {
+		++nodes_[it->second].refs;
+		// Существующий узел уже держит ссылки на свои операнды
+		for (NodeId operand : { key.lhs, key.rhs }) {
+			if (operand != NO_NODE) {
+				--nodes_[operand].refs;
+			}
+		}
+		return it->second;
+	}
+
+	NodeId id = static_cast<NodeId>(nodes_.size());
+	if (!free_nodes_.empty()) {
+		id = free_nodes_.back();
+		free_nodes_.pop_back();
+	}
+	else {
+		nodes_.emplace_back();
+	}
+	nodes_[id] = Node{ key, 1, 0, BoxedValue() };
+	ids_.emplace(key, id);
+	return id;
+}
+
+void SubexpressionPool::Remove(NodeId root) {
+	std::vector<NodeId> to_release{ root };
+	while (!to_release.empty()) {
+		const NodeId id = to_release.back();
+		to_release.pop_back();
+
+		Node& node = nodes_[id];
+		if (--node.refs > 0) {
+			continue;
+		}
+		ids_.erase(node.key);
+		free_nodes_.push_back(id);
+		for (NodeId operand : { node.key.lhs, node.key.rhs }) {
+			if (operand != NO_NODE) {
+				to_release.push_back(operand);
+			}
+		}
+	}
+}
+
+void SubexpressionPool::NextEpoch() {
+	++epoch_;
+}
+
+FormulaInterface::Value SubexpressionPool::Evaluate(NodeId root, const SheetInterface& sheet) {
+	try {
+		return Compute(root, sheet);
+	}
+	catch (const FormulaError& error) {
+		return error;
+	}
+}
+
+double SubexpressionPool::Compute(NodeId id, const SheetInterface& sheet) {
+	using Code = FormulaProgram::Op::Code;
+
+	// Узлы не добавляются во время вычисления, поэтому ссылка не инвалидируется
+	Node& node = nodes_[id];
+	switch (node.key.code) {
+	case Code::Number:
+		return FromBits(node.key.number);
+	case Code::Cell:
+		return GetCellNumber(sheet, node.key.cell);
+	default:
+		break;
+	}
+
+	if (node.epoch == epoch_) {
+		++reused_;
+		if (node.value.IsError()) {
+			throw node.value.GetError();
+		}
+		return node.value.GetNumber();
+	}
+
+	try {
+		double result = 0.0;
+		// Как и в AST, сначала вычисляется левый операнд
+		const double lhs = Compute(node.key.lhs, sheet);
+		if (node.key.code == Code::Negate) {
+			result = -lhs;
+		}
+		else {
+			const double rhs = Compute(node.key.rhs, sheet);
+			switch (node.key.code) {
+			case Code::Add:
+				result = lhs + rhs;
+				break;
+			case Code::Subtract:
+				result = lhs - rhs;
+				break;
+			case Code::Multiply:
+				result = lhs * rhs;
+				break;
+			default:
+				result = lhs / rhs;
+				break;
+			}
+			if (!std::isfinite(result)) {
+				throw FormulaError(FormulaError::Category::Div0);
+			}
+		}
+		node.value = result;
+		node.epoch = epoch_;
+		return result;
+	}
+	catch (const FormulaError& error) {
+		node.value = error;
+		node.epoch = epoch_;
+		throw;
+	}
+}
+
+std::size_t SubexpressionPool::GetMemoryUsage() const {
+	return Memory::HeapSize(nodes_) + Memory::HeapSize(free_nodes_)
+		+ ids_.size() * Memory::HASH_NODE_SIZE<decltype(ids_)::value_type>;
+}
+
+SubexpressionPool::Stats SubexpressionPool::GetStats() const {
+	Stats stats;
+	stats.nodes = ids_.size();
+	for (const auto& [key, id] : ids_) {
+		if (nodes_[id].refs > 1) {
+			++stats.shared;
+		}
+	}
+	stats.reused = reused_;
+	return stats;
+}
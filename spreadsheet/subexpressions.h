@@ -0,0 +1,85 @@
+#pragma once
+
+#include "boxed_value.h"
+#include "common.h"
+#include "formula.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Общий для всех формул листа ациклический граф подвыражений. Одинаковые
+// поддеревья формул над одними и теми же ячейками хранятся одним узлом
+// (hash-consing), а значение узла запоминается до конца текущей эпохи. Лист
+// начинает новую эпоху при каждом изменении и пересчитывает формулы так, что
+// к моменту вычисления формулы все ячейки, от которых она зависит, уже
+// посчитаны. Поэтому значение подвыражения, вычисленное в эпохе один раз,
+// верно для всех формул, в которых оно встречается
+class SubexpressionPool {
+public:
+    using NodeId = std::uint32_t;
+
+    struct Stats {
+        // Узлов в пуле
+        std::size_t nodes = 0;
+        // Узлов, которые используются в нескольких формулах или подвыражениях
+        std::size_t shared = 0;
+        // Сколько раз значение подвыражения взято из кэша вместо вычисления
+        std::size_t reused = 0;
+    };
+
+    // Регистрирует формулу и возвращает её корень. Каждый вызов нужно
+    // завершить вызовом Remove
+    NodeId Add(const FormulaProgram& program);
+    // Освобождает корень формулы и узлы, которые больше нигде не используются
+    void Remove(NodeId root);
+
+    // Значения, запомненные до этого вызова, больше не используются
+    void NextEpoch();
+    // Вычисляет формулу с корнем root по значениям ячеек sheet
+    FormulaInterface::Value Evaluate(NodeId root, const SheetInterface& sheet);
+
+    Stats GetStats() const;
+    // Память узлов пула и их индекса, за O(1)
+    std::size_t GetMemoryUsage() const;
+
+private:
+    static constexpr NodeId NO_NODE = static_cast<NodeId>(-1);
+
+    // Узел однозначно задаётся операцией и операндами
+    struct Key {
+        FormulaProgram::Op::Code code = FormulaProgram::Op::Code::Number;
+        // Число хранится побитово, так 0 и -0 - разные узлы
+        std::uint64_t number = 0;
+        Position cell;
+        NodeId lhs = NO_NODE;
+        NodeId rhs = NO_NODE;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Node {
+        Key key;
+        // Сколько формул и узлов используют этот узел
+        std::uint32_t refs = 0;
+        // Значение действительно, пока epoch совпадает с текущей эпохой пула
+        std::uint64_t epoch = 0;
+        BoxedValue value;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<NodeId> free_nodes_;
+    std::unordered_map<Key, NodeId, KeyHash> ids_;
+    std::uint64_t epoch_ = 1;
+    std::size_t reused_ = 0;
+
+    // Находит или создаёт узел. Ссылки на операнды key уже взяты вызывающим
+    NodeId Intern(const Key& key);
+    // Бросает FormulaError, как и вычисление AST
+    double Compute(NodeId id, const SheetInterface& sheet);
+};
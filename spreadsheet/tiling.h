@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common.h"
+
+// Лист разбит на квадратные тайлы. По тайлам хранятся ячейки и снимки значений
+namespace Tiling {
+
+    // Длина стороны тайла в ячейках
+    inline constexpr int TILE_SIZE = 64;
+    inline constexpr int TILES_IN_ROW = (Position::MAX_COLS + TILE_SIZE - 1) / TILE_SIZE;
+
+    inline int GetTileId(Position pos) {
+        return (pos.row / TILE_SIZE) * TILES_IN_ROW + pos.col / TILE_SIZE;
+    }
+
+    // Позиция левой верхней ячейки тайла
+    inline Position GetTileOrigin(int tile_id) {
+        return { (tile_id / TILES_IN_ROW) * TILE_SIZE, (tile_id % TILES_IN_ROW) * TILE_SIZE };
+    }
+
+    // Смещение ячейки внутри тайла. Смещения упорядочены по строкам
+    inline int GetOffset(Position pos) {
+        return (pos.row % TILE_SIZE) * TILE_SIZE + pos.col % TILE_SIZE;
+    }
+
+    inline Position GetPosition(int tile_id, int offset) {
+        const Position origin = GetTileOrigin(tile_id);
+        return { origin.row + offset / TILE_SIZE, origin.col + offset % TILE_SIZE };
+    }
+
+} // namespace Tiling
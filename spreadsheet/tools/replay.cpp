@@ -0,0 +1,146 @@
+#include "sheet.h"
+#include "trace.h"
+
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+	const char* const USAGE = R"(usage: spreadsheet_replay <trace> [--repeat N] [--shared] [--metrics] [--profile N]
+
+Re-executes a trace recorded by Sheet::StartTrace (or written by
+spreadsheet_workload --format trace) on a fresh sheet and reports
+per-operation latency percentiles and throughput.
+
+options:
+  --repeat N                replay N times, each on a fresh sheet, default 1
+  --shared                  enable the shared subexpression pool
+  --metrics                 print Sheet::GetMetrics() as JSON after each run,
+                            needs a build with -DSPREADSHEET_METRICS=ON
+  --profile N               profile recalculation and print the N hottest
+                            formulas, the N largest cascade triggers and
+                            the longest chain of dependent formulas
+)";
+
+	struct Options {
+		std::string path;
+		int repeat = 1;
+		bool shared = false;
+		bool metrics = false;
+		// Сколько ячеек выводить в профиле, 0 - без профилирования
+		std::size_t profile = 0;
+	};
+
+	Options ParseOptions(int argc, char* argv[]) {
+		Options options;
+		options.path = argv[1];
+		for (int i = 2; i < argc; ++i) {
+			const std::string_view name = argv[i];
+			if (name == "--shared") {
+				options.shared = true;
+			}
+			else if (name == "--metrics") {
+				options.metrics = true;
+			}
+			else if (name == "--profile" && i + 1 < argc) {
+				options.profile = std::stoul(argv[++i]);
+			}
+			else if (name == "--repeat" && i + 1 < argc) {
+				options.repeat = std::stoi(argv[++i]);
+			}
+			else {
+				throw std::invalid_argument("Unknown option " + std::string(name));
+			}
+		}
+		if (options.repeat < 1) {
+			throw std::invalid_argument("--repeat must be positive");
+		}
+		return options;
+	}
+
+	double Microseconds(std::chrono::nanoseconds ns) {
+		return static_cast<double>(ns.count()) / 1000.0;
+	}
+
+	void PrintLatency(const char* name, const ReplayStats::Latency& latency) {
+		if (latency.count == 0) {
+			return;
+		}
+		std::printf("%-6s %10zu %10.2f %10.2f %10.2f %10.2f\n", name, latency.count, Microseconds(latency.p50),
+			Microseconds(latency.p99), Microseconds(latency.p999), Microseconds(latency.max));
+	}
+
+	void PrintProfile(const Sheet& sheet, std::size_t n) {
+		const CellProfiler& profile = sheet.GetProfile();
+		std::printf("hot cells:\n%-8s %12s %12s %12s\n", "cell", "evaluations", "total us", "mean us");
+		for (const auto& cell : profile.GetHotCells(n)) {
+			std::printf("%-8s %12zu %12.2f %12.2f\n", cell.pos.ToString().c_str(), cell.evaluations,
+				Microseconds(cell.time), Microseconds(profile.GetMeanTime(cell.pos)));
+		}
+		std::printf("cascade triggers:\n%-8s %12s %12s %12s %12s\n", "cell", "cascades", "invalidated", "max", "evaluated");
+		for (const auto& trigger : profile.GetTriggers(n)) {
+			std::printf("%-8s %12zu %12zu %12zu %12zu\n", trigger.pos.ToString().c_str(), trigger.cascades,
+				trigger.invalidated, trigger.max_invalidated, trigger.evaluated);
+		}
+		const auto path = sheet.GetCriticalPath();
+		std::printf("critical path: %zu formulas, %.2f us", path.cells.size(), Microseconds(path.time));
+		if (!path.cells.empty()) {
+			std::printf(", %s -> %s", path.cells.front().ToString().c_str(), path.cells.back().ToString().c_str());
+		}
+		std::printf("\n");
+	}
+
+	void PrintStats(const ReplayStats& stats) {
+		std::printf("%-6s %10s %10s %10s %10s %10s\n", "op", "count", "p50 us", "p99 us", "p999 us", "max us");
+		PrintLatency("set", stats.Get(WorkloadOp::Kind::Set));
+		PrintLatency("clear", stats.Get(WorkloadOp::Kind::Clear));
+		PrintLatency("get", stats.Get(WorkloadOp::Kind::Get));
+		std::printf("rejected: %zu, total: %.3f ms, throughput: %.0f ops/s\n", stats.rejected,
+			static_cast<double>(stats.total.count()) / 1e6, stats.GetThroughput());
+	}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << USAGE;
+		return 1;
+	}
+	try {
+		const Options options = ParseOptions(argc, argv);
+		std::ifstream in(options.path, std::ios::binary);
+		if (!in) {
+			throw std::invalid_argument("Cannot open " + options.path);
+		}
+		const auto ops = ReadTrace(in);
+
+		for (int run = 1; run <= options.repeat; ++run) {
+			Sheet sheet;
+			if (options.shared) {
+				sheet.ShareSubexpressions();
+			}
+			if (options.repeat > 1) {
+				std::printf("run %d\n", run);
+			}
+			if (options.profile > 0) {
+				sheet.StartProfiling();
+			}
+			PrintStats(ReplayTrace(sheet, ops));
+			if (options.profile > 0) {
+				PrintProfile(sheet, options.profile);
+			}
+			if (options.metrics) {
+				sheet.GetMetrics().WriteJson(std::cout);
+				std::cout << std::endl;
+			}
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << '\n' << USAGE;
+		return 1;
+	}
+	return 0;
+}
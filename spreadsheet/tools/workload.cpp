@@ -0,0 +1,138 @@
+#include "trace.h"
+#include "workload.h"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+	const char* const USAGE = R"(usage: spreadsheet_workload <kind> [--option value]...
+
+Prints a reproducible workload to stdout.
+
+kinds and the options they use:
+  chain    --count          A1 = 1, A2 = A1+1, ...
+  fanout   --count          count formulas over A1
+  fanin    --count          A1 over count input cells
+  dag      --rows --cols --count --formulas --refs
+                            random DAG of count cells, a share of formulas
+                            with up to refs references each
+  columns  --rows --cols    cols columns of filled-down formulas
+  layout   --rows --cols --density
+                            numbers and texts in a share of the area
+  edits    --rows --cols --count
+                            random edits, some rejected by the sheet
+
+common options:
+  --seed N                  default 1
+  --format ops|tsv|trace    SetCell/ClearCell stream, PrintTexts table or binary
+                            trace for spreadsheet_replay, default ops
+)";
+
+	struct Options {
+		std::uint64_t seed = 1;
+		int count = 1000;
+		int rows = 1000;
+		int cols = 26;
+		double density = 0.1;
+		double formulas = 0.5;
+		int refs = 3;
+		std::string format = "ops";
+	};
+
+	Options ParseOptions(int argc, char* argv[]) {
+		Options options;
+		for (int i = 2; i < argc; i += 2) {
+			const std::string_view name = argv[i];
+			if (i + 1 >= argc) {
+				throw std::invalid_argument("Missing value for " + std::string(name));
+			}
+			const std::string value = argv[i + 1];
+			if (name == "--seed") {
+				options.seed = std::stoull(value);
+			}
+			else if (name == "--count") {
+				options.count = std::stoi(value);
+			}
+			else if (name == "--rows") {
+				options.rows = std::stoi(value);
+			}
+			else if (name == "--cols") {
+				options.cols = std::stoi(value);
+			}
+			else if (name == "--density") {
+				options.density = std::stod(value);
+			}
+			else if (name == "--formulas") {
+				options.formulas = std::stod(value);
+			}
+			else if (name == "--refs") {
+				options.refs = std::stoi(value);
+			}
+			else if (name == "--format" && (value == "ops" || value == "tsv" || value == "trace")) {
+				options.format = value;
+			}
+			else {
+				throw std::invalid_argument("Unknown option " + std::string(name) + " " + value);
+			}
+		}
+		return options;
+	}
+
+	std::vector<WorkloadOp> Generate(std::string_view kind, const Options& options) {
+		WorkloadGenerator generator(options.seed);
+		const Size size{ options.rows, options.cols };
+		if (kind == "chain") {
+			return generator.Chain(options.count);
+		}
+		if (kind == "fanout") {
+			return generator.FanOut(options.count);
+		}
+		if (kind == "fanin") {
+			return generator.FanIn(options.count);
+		}
+		if (kind == "dag") {
+			return generator.RandomDag(size, options.count, options.formulas, options.refs);
+		}
+		if (kind == "columns") {
+			return generator.FilledColumns(options.rows, options.cols);
+		}
+		if (kind == "layout") {
+			return generator.Layout(size, options.density);
+		}
+		if (kind == "edits") {
+			return generator.Edits(size, options.count);
+		}
+		throw std::invalid_argument("Unknown workload kind " + std::string(kind));
+	}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << USAGE;
+		return 1;
+	}
+	try {
+		const Options options = ParseOptions(argc, argv);
+		const auto ops = Generate(argv[1], options);
+		std::ios::sync_with_stdio(false);
+		if (options.format == "tsv") {
+			WriteTsv(ops, std::cout);
+		}
+		else if (options.format == "trace") {
+			WriteTrace(ops, std::cout);
+		}
+		else {
+			WriteWorkload(ops, std::cout);
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << '\n' << USAGE;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,179 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+	// Буфер сбрасывается в поток, когда вырастает до этого размера
+	constexpr std::size_t FLUSH_SIZE = 64 * 1024;
+
+	void WriteVarint(std::string& out, std::uint64_t value) {
+		while (value >= 0x80) {
+			out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<char>(value));
+	}
+
+	[[noreturn]] void ThrowBrokenTrace() {
+		throw std::invalid_argument("Broken trace");
+	}
+
+	std::uint64_t ReadVarint(std::istream& in) {
+		std::uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			const int byte = in.get();
+			if (byte == std::istream::traits_type::eof()) {
+				ThrowBrokenTrace();
+			}
+			value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) {
+				return value;
+			}
+		}
+		ThrowBrokenTrace();
+	}
+
+	int ReadCoordinate(std::istream& in, int limit) {
+		const std::uint64_t value = ReadVarint(in);
+		if (value >= static_cast<std::uint64_t>(limit)) {
+			ThrowBrokenTrace();
+		}
+		return static_cast<int>(value);
+	}
+
+	// Ближайший сверху ранг: значение, не меньше которого доля q задержек
+	std::chrono::nanoseconds Percentile(const std::vector<std::chrono::nanoseconds>& sorted, double q) {
+		const std::size_t rank = static_cast<std::size_t>(q * static_cast<double>(sorted.size()) + 0.999999);
+		return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+	}
+} // namespace
+
+TraceWriter::TraceWriter(std::ostream& out)
+	: out_(out)
+	, buffer_(TRACE_MAGIC) {
+	buffer_.reserve(FLUSH_SIZE + 64);
+}
+
+TraceWriter::~TraceWriter() {
+	Flush();
+}
+
+void TraceWriter::Write(WorkloadOp::Kind kind, Position pos, std::string_view text) {
+	buffer_.push_back(static_cast<char>(kind));
+	WriteVarint(buffer_, static_cast<std::uint64_t>(pos.row));
+	WriteVarint(buffer_, static_cast<std::uint64_t>(pos.col));
+	if (kind == WorkloadOp::Kind::Set) {
+		WriteVarint(buffer_, text.size());
+		buffer_.append(text);
+	}
+	++count_;
+	if (buffer_.size() >= FLUSH_SIZE) {
+		Flush();
+	}
+}
+
+void TraceWriter::Flush() {
+	out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+	out_.flush();
+	buffer_.clear();
+}
+
+std::size_t TraceWriter::GetCount() const {
+	return count_;
+}
+
+void WriteTrace(const std::vector<WorkloadOp>& ops, std::ostream& out) {
+	TraceWriter writer(out);
+	for (const WorkloadOp& op : ops) {
+		writer.Write(op.kind, op.pos, op.text);
+	}
+}
+
+std::vector<WorkloadOp> ReadTrace(std::istream& in) {
+	std::string magic(TRACE_MAGIC.size(), '\0');
+	if (!in.read(magic.data(), static_cast<std::streamsize>(magic.size())) || magic != TRACE_MAGIC) {
+		throw std::invalid_argument("Not a spreadsheet trace");
+	}
+
+	std::vector<WorkloadOp> ops;
+	for (int kind = in.get(); kind != std::istream::traits_type::eof(); kind = in.get()) {
+		if (kind > static_cast<int>(WorkloadOp::Kind::Get)) {
+			ThrowBrokenTrace();
+		}
+		WorkloadOp op;
+		op.kind = static_cast<WorkloadOp::Kind>(kind);
+		op.pos.row = ReadCoordinate(in, Position::MAX_ROWS);
+		op.pos.col = ReadCoordinate(in, Position::MAX_COLS);
+		if (op.kind == WorkloadOp::Kind::Set) {
+			const std::uint64_t size = ReadVarint(in);
+			// Длину не берём на веру: повреждённая трасса не должна выделять гигабайты
+			while (op.text.size() < size) {
+				char chunk[4096];
+				const std::size_t chunk_size = static_cast<std::size_t>(std::min<std::uint64_t>(sizeof(chunk), size - op.text.size()));
+				if (!in.read(chunk, static_cast<std::streamsize>(chunk_size))) {
+					ThrowBrokenTrace();
+				}
+				op.text.append(chunk, chunk_size);
+			}
+		}
+		ops.push_back(std::move(op));
+	}
+	return ops;
+}
+
+const ReplayStats::Latency& ReplayStats::Get(WorkloadOp::Kind kind) const {
+	return latencies[static_cast<int>(kind)];
+}
+
+double ReplayStats::GetThroughput() const {
+	std::size_t count = 0;
+	for (const Latency& latency : latencies) {
+		count += latency.count;
+	}
+	return total.count() > 0 ? static_cast<double>(count) * 1e9 / static_cast<double>(total.count()) : 0.0;
+}
+
+ReplayStats ReplayTrace(SheetInterface& sheet, const std::vector<WorkloadOp>& ops) {
+	using Clock = std::chrono::steady_clock;
+
+	// Память под замеры выделяется заранее, чтобы не попасть в замеры
+	std::size_t counts[3] = {};
+	for (const WorkloadOp& op : ops) {
+		++counts[static_cast<int>(op.kind)];
+	}
+	std::vector<std::chrono::nanoseconds> durations[3];
+	for (int kind = 0; kind < 3; ++kind) {
+		durations[kind].reserve(counts[kind]);
+	}
+
+	ReplayStats stats;
+	for (const WorkloadOp& op : ops) {
+		const auto start = Clock::now();
+		const bool applied = ApplyWorkloadOp(sheet, op);
+		const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+		if (!applied) {
+			++stats.rejected;
+		}
+		durations[static_cast<int>(op.kind)].push_back(duration);
+		stats.total += duration;
+	}
+
+	for (int kind = 0; kind < 3; ++kind) {
+		auto& sorted = durations[kind];
+		if (sorted.empty()) {
+			continue;
+		}
+		std::sort(sorted.begin(), sorted.end());
+		auto& latency = stats.latencies[kind];
+		latency.count = sorted.size();
+		latency.p50 = Percentile(sorted, 0.5);
+		latency.p99 = Percentile(sorted, 0.99);
+		latency.p999 = Percentile(sorted, 0.999);
+		latency.max = sorted.back();
+	}
+	return stats;
+}
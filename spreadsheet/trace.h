@@ -0,0 +1,67 @@
+#pragma once
+
+#include "common.h"
+#include "workload.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Двоичная трасса вызовов листа. После заголовка TRACE_MAGIC каждая операция
+// записана байтом вида (WorkloadOp::Kind), строкой и столбцом ячейки в виде
+// беззнаковых LEB128 и, для записи, длиной текста в LEB128 и самим текстом.
+// Чтение ячейки занимает 3-5 байт
+inline constexpr std::string_view TRACE_MAGIC = "SSTRACE1";
+
+// Пишет операции в поток трассы. Записи копятся в буфере и сбрасываются
+// в поток большими блоками, при разрушении объекта - полностью
+class TraceWriter {
+public:
+    explicit TraceWriter(std::ostream& out);
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+    ~TraceWriter();
+
+    void Write(WorkloadOp::Kind kind, Position pos, std::string_view text = {});
+    // Сбрасывает буфер в поток
+    void Flush();
+    // Сколько операций записано
+    std::size_t GetCount() const;
+
+private:
+    std::ostream& out_;
+    std::string buffer_;
+    std::size_t count_ = 0;
+};
+
+void WriteTrace(const std::vector<WorkloadOp>& ops, std::ostream& out);
+// Бросает std::invalid_argument, если поток не является трассой или обрывается посреди записи
+std::vector<WorkloadOp> ReadTrace(std::istream& in);
+
+struct ReplayStats {
+    // Задержки операций одного вида
+    struct Latency {
+        std::size_t count = 0;
+        std::chrono::nanoseconds p50{};
+        std::chrono::nanoseconds p99{};
+        std::chrono::nanoseconds p999{};
+        std::chrono::nanoseconds max{};
+    };
+
+    // По видам операций, индекс - WorkloadOp::Kind
+    Latency latencies[3];
+    // Операции, которые лист отклонил исключением
+    std::size_t rejected = 0;
+    // Суммарное время выполнения операций без учёта замеров
+    std::chrono::nanoseconds total{};
+
+    const Latency& Get(WorkloadOp::Kind kind) const;
+    // Операций в секунду
+    double GetThroughput() const;
+};
+
+// Выполняет операции над листом, как ApplyWorkload, замеряя время каждой
+ReplayStats ReplayTrace(SheetInterface& sheet, const std::vector<WorkloadOp>& ops);
@@ -0,0 +1,336 @@
+#include "workload.h"
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+	Position ColumnMajor(int index, int first_col) {
+		return { index % Position::MAX_ROWS, first_col + index / Position::MAX_ROWS };
+	}
+
+	void CheckCount(int count, std::int64_t capacity) {
+		if (count < 0 || count > capacity) {
+			throw std::invalid_argument("Workload does not fit into the sheet");
+		}
+	}
+
+	void CheckSize(Size size) {
+		if (size.rows <= 0 || size.cols <= 0 || size.rows > Position::MAX_ROWS || size.cols > Position::MAX_COLS) {
+			throw std::invalid_argument("Invalid workload area");
+		}
+	}
+
+	WorkloadOp Set(Position pos, std::string text) {
+		return { WorkloadOp::Kind::Set, pos, std::move(text) };
+	}
+} // namespace
+
+bool WorkloadOp::operator==(const WorkloadOp& other) const {
+	return kind == other.kind && pos == other.pos && text == other.text;
+}
+
+WorkloadGenerator::WorkloadGenerator(std::uint64_t seed)
+	: random_(seed) {
+}
+
+int WorkloadGenerator::Uniform(int bound) {
+	return static_cast<int>(random_() % static_cast<std::uint64_t>(bound));
+}
+
+bool WorkloadGenerator::Chance(double probability) {
+	// 53 старших бита дают равномерное число в [0, 1)
+	return static_cast<double>(random_() >> 11) * 0x1.0p-53 < probability;
+}
+
+Position WorkloadGenerator::RandomPosition(Size size) {
+	return { Uniform(size.rows), Uniform(size.cols) };
+}
+
+std::vector<Position> WorkloadGenerator::DistinctPositions(Size size, int count) {
+	const std::int64_t area = static_cast<std::int64_t>(size.rows) * size.cols;
+	CheckCount(count, area);
+
+	std::vector<Position> positions;
+	positions.reserve(count);
+	// Почти вся область: проходим её по строкам и берём каждую позицию с вероятностью
+	// (осталось выбрать) / (осталось позиций), затем перемешиваем выбранные.
+	// Память зависит только от числа выбранных позиций
+	if (static_cast<std::int64_t>(count) * 2 > area) {
+		int remaining = static_cast<int>(area);
+		for (int row = 0; row < size.rows; ++row) {
+			for (int col = 0; col < size.cols; ++col, --remaining) {
+				if (Uniform(remaining) < count - static_cast<int>(positions.size())) {
+					positions.push_back({ row, col });
+				}
+			}
+		}
+		for (int i = count - 1; i > 0; --i) {
+			std::swap(positions[i], positions[Uniform(i + 1)]);
+		}
+		return positions;
+	}
+
+	// Иначе случайные позиции без повторов
+	std::unordered_set<std::int64_t> used;
+	while (static_cast<int>(positions.size()) < count) {
+		const Position pos = RandomPosition(size);
+		if (used.insert(static_cast<std::int64_t>(pos.row) * Position::MAX_COLS + pos.col).second) {
+			positions.push_back(pos);
+		}
+	}
+	return positions;
+}
+
+std::string WorkloadGenerator::RandomNumber() {
+	const std::string number = std::to_string(Uniform(2001) - 1000);
+	return Chance(0.5) ? number : number + ".25";
+}
+
+std::string WorkloadGenerator::RandomFormula(const std::vector<Position>& refs) {
+	static constexpr char operations[] = { '+', '-', '*', '/' };
+	std::string formula = "=" + refs.front().ToString();
+	for (std::size_t i = 1; i < refs.size(); ++i) {
+		formula += operations[Uniform(4)];
+		formula += refs[i].ToString();
+	}
+	// Иногда формула использует и число
+	if (Chance(0.3)) {
+		formula += operations[Uniform(3)];
+		formula += std::to_string(Uniform(9) + 1);
+	}
+	return formula;
+}
+
+std::vector<WorkloadOp> WorkloadGenerator::Chain(int length) {
+	CheckCount(length, static_cast<std::int64_t>(Position::MAX_ROWS) * Position::MAX_COLS);
+	std::vector<WorkloadOp> ops;
+	ops.reserve(length);
+	for (int i = 0; i < length; ++i) {
+		ops.push_back(Set(ColumnMajor(i, 0), i == 0 ? "1" : "=" + ColumnMajor(i - 1, 0).ToString() + "+1"));
+	}
+	return ops;
+}
+
+std::vector<WorkloadOp> WorkloadGenerator::FanOut(int count) {
+	CheckCount(count, static_cast<std::int64_t>(Position::MAX_ROWS) * (Position::MAX_COLS - 1));
+	std::vector<WorkloadOp> ops;
+	ops.reserve(count + 1);
+	ops.push_back(Set({ 0, 0 }, RandomNumber()));
+	for (int i = 0; i < count; ++i) {
+		ops.push_back(Set(ColumnMajor(i, 1), RandomFormula({ { 0, 0 } })));
+	}
+	return ops;
+}
+
+std::vector<WorkloadOp> WorkloadGenerator::FanIn(int count) {
+	CheckCount(count, static_cast<std::int64_t>(Position::MAX_ROWS) * (Position::MAX_COLS - 1));
+	std::vector<WorkloadOp> ops;
+	ops.reserve(count + 1);
+	std::vector<Position> inputs;
+	for (int i = 0; i < count; ++i) {
+		inputs.push_back(ColumnMajor(i, 1));
+		ops.push_back(Set(inputs.back(), RandomNumber()));
+	}
+	if (!inputs.empty()) {
+		ops.push_back(Set({ 0, 0 }, RandomFormula(inputs)));
+	}
+	return ops;
+}
+
+std::vector<WorkloadOp> WorkloadGenerator::RandomDag(Size size, int cells, double formula_share, int max_refs) {
+	CheckSize(size);
+	// Формула ссылается только на ячейки, созданные раньше неё, а позиции не
+	// повторяются, поэтому циклов нет
+	const auto positions = DistinctPositions(size, cells);
+	std::vector<WorkloadOp> ops;
+	ops.reserve(cells);
+	std::vector<Position> refs;
+	for (int i = 0; i < cells; ++i) {
+		if (i == 0 || max_refs <= 0 || !Chance(formula_share)) {
+			ops.push_back(Set(positions[i], RandomNumber()));
+			continue;
+		}
+		refs.resize(1 + Uniform(std::min(max_refs, i)));
+		for (Position& ref : refs) {
+			ref = positions[Uniform(i)];
+		}
+		ops.push_back(Set(positions[i], RandomFormula(refs)));
+	}
+	return ops;
+}
+
+std::vector<WorkloadOp> WorkloadGenerator::FilledColumns(int rows, int formula_cols) {
+	CheckSize({ rows, formula_cols + 2 });
+	std::vector<WorkloadOp> ops;
+	ops.reserve(static_cast<std::size_t>(rows) * (formula_cols + 2));
+	for (int row = 0; row < rows; ++row) {
+		const std::string row_number = std::to_string(row + 1);
+		ops.push_back(Set({ row, 0 }, RandomNumber()));
+		ops.push_back(Set({ row, 1 }, RandomNumber()));
+		for (int k = 0; k < formula_cols; ++k) {
+			const Position pos{ row, 2 + k };
+			if (k == 0) {
+				ops.push_back(Set(pos, "=A" + row_number + "*B" + row_number + "-A1"));
+			}
+			else {
+				ops.push_back(Set(pos, "=" + Position{ row, 1 + k }.ToString() + "/2+B" + row_number));
+			}
+		}
+	}
+	return ops;
+}
+
+std::vector<WorkloadOp> WorkloadGenerator::Layout(Size size, double density) {
+	CheckSize(size);
+	const std::int64_t area = static_cast<std::int64_t>(size.rows) * size.cols;
+	const double count = std::round(static_cast<double>(area) * std::clamp(density, 0.0, 1.0));
+	std::vector<WorkloadOp> ops;
+	for (Position pos : DistinctPositions(size, static_cast<int>(count))) {
+		ops.push_back(Set(pos, Chance(0.7) ? RandomNumber() : "text" + std::to_string(Uniform(1000))));
+	}
+	return ops;
+}
+
+std::vector<WorkloadOp> WorkloadGenerator::Edits(Size size, int count) {
+	CheckSize(size);
+	std::vector<WorkloadOp> ops;
+	ops.reserve(count);
+	std::vector<Position> refs;
+	for (int i = 0; i < count; ++i) {
+		const Position pos = RandomPosition(size);
+		switch (Uniform(10)) {
+		case 0:
+		case 1:
+		case 2:
+		case 3:
+			ops.push_back(Set(pos, RandomNumber()));
+			break;
+		case 4:
+			ops.push_back(Set(pos, "text"));
+			break;
+		case 5:
+		case 6:
+			refs.resize(1 + Uniform(3));
+			for (Position& ref : refs) {
+				ref = RandomPosition(size);
+			}
+			ops.push_back(Set(pos, RandomFormula(refs)));
+			break;
+		case 7:
+			ops.push_back(Set(pos, "=" + RandomPosition(size).ToString() + "+"));
+			break;
+		default:
+			ops.push_back({ WorkloadOp::Kind::Clear, pos, {} });
+			break;
+		}
+	}
+	return ops;
+}
+
+std::size_t ApplyWorkload(SheetInterface& sheet, const std::vector<WorkloadOp>& ops) {
+	std::size_t rejected = 0;
+	for (const WorkloadOp& op : ops) {
+		if (!ApplyWorkloadOp(sheet, op)) {
+			++rejected;
+		}
+	}
+	return rejected;
+}
+
+bool ApplyWorkloadOp(SheetInterface& sheet, const WorkloadOp& op) {
+	try {
+		switch (op.kind) {
+		case WorkloadOp::Kind::Set:
+			sheet.SetCell(op.pos, op.text);
+			break;
+		case WorkloadOp::Kind::Clear:
+			sheet.ClearCell(op.pos);
+			break;
+		case WorkloadOp::Kind::Get:
+			sheet.GetCell(op.pos);
+			break;
+		}
+	}
+	catch (const FormulaException&) {
+		return false;
+	}
+	catch (const CircularDependencyException&) {
+		return false;
+	}
+	return true;
+}
+
+void WriteWorkload(const std::vector<WorkloadOp>& ops, std::ostream& out) {
+	for (const WorkloadOp& op : ops) {
+		switch (op.kind) {
+		case WorkloadOp::Kind::Set:
+			out << "set\t" << op.pos.ToString() << '\t' << op.text << '\n';
+			break;
+		case WorkloadOp::Kind::Clear:
+			out << "clear\t" << op.pos.ToString() << '\n';
+			break;
+		case WorkloadOp::Kind::Get:
+			out << "get\t" << op.pos.ToString() << '\n';
+			break;
+		}
+	}
+}
+
+std::vector<WorkloadOp> ReadWorkload(std::istream& in) {
+	std::vector<WorkloadOp> ops;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.empty()) {
+			continue;
+		}
+		const std::size_t kind_end = line.find('\t');
+		const std::string_view kind = std::string_view(line).substr(0, kind_end);
+		const std::size_t pos_end = kind_end == std::string::npos ? kind_end : line.find('\t', kind_end + 1);
+		const Position pos = kind_end == std::string::npos
+			? Position::NONE
+			: Position::FromString(std::string_view(line).substr(kind_end + 1, pos_end - kind_end - 1));
+		if (!pos.IsValid()) {
+			throw std::invalid_argument("Invalid workload line: " + line);
+		}
+
+		if (kind == "set" && pos_end != std::string::npos) {
+			ops.push_back(Set(pos, line.substr(pos_end + 1)));
+		}
+		else if (kind == "clear" && pos_end == std::string::npos) {
+			ops.push_back({ WorkloadOp::Kind::Clear, pos, {} });
+		}
+		else if (kind == "get" && pos_end == std::string::npos) {
+			ops.push_back({ WorkloadOp::Kind::Get, pos, {} });
+		}
+		else {
+			throw std::invalid_argument("Invalid workload line: " + line);
+		}
+	}
+	return ops;
+}
+
+void WriteTsv(const std::vector<WorkloadOp>& ops, std::ostream& out) {
+	auto sheet = CreateSheet();
+	ApplyWorkload(*sheet, ops);
+	sheet->PrintTexts(out);
+}
+
+std::vector<WorkloadOp> ReadTsv(std::istream& in) {
+	std::vector<WorkloadOp> ops;
+	std::string line;
+	for (int row = 0; std::getline(in, line); ++row) {
+		int col = 0;
+		for (std::size_t begin = 0; begin <= line.size(); ++col) {
+			const std::size_t end = std::min(line.find('\t', begin), line.size());
+			if (end > begin) {
+				ops.push_back(Set({ row, col }, line.substr(begin, end - begin)));
+			}
+			begin = end + 1;
+		}
+	}
+	return ops;
+}
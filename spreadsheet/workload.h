@@ -0,0 +1,92 @@
+#pragma once
+
+#include "common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <random>
+#include <string>
+#include <vector>
+
+// Операция над листом: запись текста в ячейку, её очистка или чтение
+struct WorkloadOp {
+    enum class Kind {
+        Set,
+        Clear,
+        Get,
+    };
+
+    Kind kind = Kind::Set;
+    Position pos;
+    // Текст для Kind::Set
+    std::string text;
+
+    bool operator==(const WorkloadOp& other) const;
+};
+
+// Генератор воспроизводимых нагрузок для замеров и стресс-тестов. Одно и то
+// же зерно даёт одни и те же операции на любой платформе. Все нагрузки, кроме
+// Edits, не содержат циклических зависимостей и неверных формул. Если нагрузка
+// не помещается в лист, методы бросают std::invalid_argument
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(std::uint64_t seed);
+
+    // Цепочка A1 = 1, A2 = A1+1, ... длины length. Ячейки заполняют столбцы
+    // сверху вниз, дойдя до последней строки, цепочка переходит в следующий столбец
+    std::vector<WorkloadOp> Chain(int length);
+    // Входная ячейка A1 и count формул, которые зависят только от неё,
+    // в столбцах начиная с B
+    std::vector<WorkloadOp> FanOut(int count);
+    // count входных ячеек в столбцах начиная с B и формула A1, которая
+    // зависит от всех. Текст формулы растёт линейно с count
+    std::vector<WorkloadOp> FanIn(int count);
+    // Случайный ациклический граф из cells ячеек в области size. Доля
+    // formula_share ячеек - формулы с 1..max_refs ссылками на ячейки,
+    // созданные раньше, остальные - числа
+    std::vector<WorkloadOp> RandomDag(Size size, int cells, double formula_share, int max_refs);
+    // Протянутые формулы: числа в столбцах A и B, а в formula_cols следующих
+    // столбцах - формулы одинаковой формы над ячейками той же строки
+    std::vector<WorkloadOp> FilledColumns(int rows, int formula_cols);
+    // Числа и тексты в доле density ячеек области size: при малой density
+    // разреженный лист, при density = 1 - плотный
+    std::vector<WorkloadOp> Layout(Size size, double density);
+    // count случайных изменений в области size: числа, тексты, формулы со
+    // ссылками в пределах области и очистки. Часть формул образует циклы или
+    // синтаксически неверна
+    std::vector<WorkloadOp> Edits(Size size, int count);
+
+private:
+    std::mt19937_64 random_;
+
+    // Равномерно распределённое число в [0, bound). Не через стандартные
+    // распределения, результат которых зависит от реализации библиотеки
+    int Uniform(int bound);
+    bool Chance(double probability);
+    Position RandomPosition(Size size);
+    // count различных позиций области size в случайном порядке
+    std::vector<Position> DistinctPositions(Size size, int count);
+    std::string RandomNumber();
+    // Формула над refs со случайными операциями
+    std::string RandomFormula(const std::vector<Position>& refs);
+};
+
+// Выполняет операции над листом. Операции, которые лист отклоняет исключением
+// (цикл, неверная формула), пропускаются. Возвращает их число
+std::size_t ApplyWorkload(SheetInterface& sheet, const std::vector<WorkloadOp>& ops);
+// Выполняет одну операцию. Возвращает false, если лист её отклонил
+bool ApplyWorkloadOp(SheetInterface& sheet, const WorkloadOp& op);
+
+// Поток операций в текстовом виде, по одной в строке: "set\tA1\tтекст", "clear\tA1"
+// или "get\tA1".
+// Тексты не должны содержать перевода строки. ReadWorkload бросает
+// std::invalid_argument на строке неверного формата
+void WriteWorkload(const std::vector<WorkloadOp>& ops, std::ostream& out);
+std::vector<WorkloadOp> ReadWorkload(std::istream& in);
+
+// Таблица в формате PrintTexts: строки листа через '\n', ячейки через '\t'.
+// WriteTsv выполняет операции на новом листе и печатает его тексты,
+// ReadTsv возвращает операции записи непустых ячеек таблицы
+void WriteTsv(const std::vector<WorkloadOp>& ops, std::ostream& out);
+std::vector<WorkloadOp> ReadTsv(std::istream& in);